@@ -8,6 +8,7 @@
 #include "Timer_group.h"
 #include "persist_util.h"
 #include "Wakeup_manager.h"
+#include "Model_events.h"
 
 #include <pebble.h>
 
@@ -71,19 +72,20 @@ static struct App_data* app_data_load()
 {
   if (!persist_exists(PERSIST_VERSION_KEY)) {
     APP_LOG(APP_LOG_LEVEL_INFO, "No data saved, creating new data with default values");
-    persist_write_int(PERSIST_VERSION_KEY, PERSIST_VERSION);
+    persist_util_write_int(PERSIST_VERSION_KEY, PERSIST_VERSION);
     return app_data_create();
   }
   if (persist_read_int(PERSIST_VERSION_KEY) != PERSIST_VERSION) {
     APP_LOG(APP_LOG_LEVEL_ERROR, "Persist version changed from %d to %d, resetting data",
       (int) persist_read_int(PERSIST_VERSION_KEY), PERSIST_VERSION);
-    persist_write_int(PERSIST_VERSION_KEY, PERSIST_VERSION);
+    persist_util_write_int(PERSIST_VERSION_KEY, PERSIST_VERSION);
     return app_data_create();
   }
   struct App_data* app_data = safe_alloc(sizeof(struct App_data));
   app_data->settings = settings_load();
   app_data->wakeup_manager = wakeup_manager_load();
   app_data->timer_groups = list_load((List_load_item_fp_t) timer_group_load);
+  wakeup_manager_reconcile(app_data->wakeup_manager, app_data->timer_groups);
   return app_data;
 }
 
@@ -102,6 +104,22 @@ struct List* app_data_get_timer_groups(const struct App_data* app_data)
   return app_data->timer_groups;
 }
 
+void app_data_add_timer_group(struct App_data* app_data, struct Timer_group* timer_group)
+{
+  assert(app_data);
+  assert(timer_group);
+  list_add(app_data->timer_groups, timer_group);
+  model_events_notify(MODEL_EVENT_GROUP_ADDED, timer_group);
+}
+
+void app_data_remove_timer_group(struct App_data* app_data, int timer_group_index)
+{
+  assert(app_data);
+  struct Timer_group* timer_group = list_get(app_data->timer_groups, timer_group_index);
+  list_remove(app_data->timer_groups, timer_group_index);
+  model_events_notify(MODEL_EVENT_GROUP_REMOVED, timer_group);
+}
+
 struct Settings* app_data_get_settings(const struct App_data* app_data)
 {
   assert(app_data);
@@ -19,6 +19,11 @@ struct App_data* app_data_get();
 void app_data_destroy();
 
 struct List* app_data_get_timer_groups(const struct App_data* app_data);
+// Add the group at the end and post MODEL_EVENT_GROUP_ADDED. The app data
+// takes ownership of it.
+void app_data_add_timer_group(struct App_data* app_data, struct Timer_group* timer_group);
+// Remove the group at index without destroying it and post MODEL_EVENT_GROUP_REMOVED
+void app_data_remove_timer_group(struct App_data* app_data, int timer_group_index);
 
 struct Settings* app_data_get_settings(const struct App_data* app_data);
 
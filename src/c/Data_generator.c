@@ -0,0 +1,44 @@
+#include "Data_generator.h"
+
+void data_generator_init(struct Data_generator* generator, const struct Data_generator_params* params)
+{
+  generator->params = *params;
+  // xorshift gets stuck at 0
+  generator->state = params->seed ? params->seed : 1;
+}
+
+void data_generator_next_group(struct Data_generator* generator, struct Generated_group* group)
+{
+  group->repeat_style = data_generator_next_int(generator, REPEAT_STYLE_INVALID);
+  group->progress_style = data_generator_next_int(generator, PROGRESS_STYLE_INVALID);
+  group->vibrate_style = data_generator_next_int(generator, VIBRATE_STYLE_INVALID);
+  group->running_timer_index = -1;
+  if (generator->params.num_timers > 0 &&
+      data_generator_next_int(generator, 100) < generator->params.running_percent) {
+    group->running_timer_index = data_generator_next_int(generator, generator->params.num_timers);
+  }
+}
+
+int data_generator_next_length(struct Data_generator* generator)
+{
+  int min_length = generator->params.min_length;
+  int max_length = generator->params.max_length;
+  if (max_length <= min_length) {
+    return min_length;
+  }
+  return min_length + data_generator_next_int(generator, max_length - min_length + 1);
+}
+
+int data_generator_next_int(struct Data_generator* generator, int bound)
+{
+  if (bound <= 0) {
+    return 0;
+  }
+  // xorshift32
+  uint32_t x = generator->state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  generator->state = x;
+  return x % (uint32_t) bound;
+}
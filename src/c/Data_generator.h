@@ -0,0 +1,43 @@
+#ifndef DATA_GENERATOR_H
+#define DATA_GENERATOR_H
+
+/*
+Generates random timer groups from a seed, so a dataset can be recreated
+exactly: on the watch through the debug menu, and on the host through
+tools/data_generator.c. Doesn't depend on the Pebble SDK.
+*/
+
+#include "Settings.h"
+
+#include <stdint.h>
+
+struct Data_generator_params {
+  int num_groups;
+  int num_timers;      // Per group
+  int min_length;      // Timer lengths, in seconds
+  int max_length;
+  int running_percent; // Chance that a group has a running timer
+  uint32_t seed;       // Must not be 0
+};
+
+struct Generated_group {
+  enum Repeat_style repeat_style;
+  enum Progress_style progress_style;
+  enum Vibrate_style vibrate_style;
+  int running_timer_index; // Negative if no timer runs
+};
+
+struct Data_generator {
+  struct Data_generator_params params;
+  uint32_t state;
+};
+
+void data_generator_init(struct Data_generator* generator, const struct Data_generator_params* params);
+// Settings of the next group. Its params.num_timers lengths follow.
+void data_generator_next_group(struct Data_generator* generator, struct Generated_group* group);
+// Length of the next timer, in seconds
+int data_generator_next_length(struct Data_generator* generator);
+// Return a number in [0, bound)
+int data_generator_next_int(struct Data_generator* generator, int bound);
+
+#endif /*DATA_GENERATOR_H*/
@@ -0,0 +1,169 @@
+#include "Heap.h"
+#include "Utility.h"
+#include "assert.h"
+
+#include <pebble.h>
+
+#define DEFAULT_ARRAY_SIZE 4
+#define GROW_FACTOR 2
+
+struct Heap {
+  void** array;
+  int allocated_size;
+  int size;
+  Heap_compare_fp_t compare;
+};
+
+static void grow_heap_intern(struct Heap* heap);
+static void sift_up_intern(struct Heap* heap, int index);
+static void sift_down_intern(struct Heap* heap, int index);
+static void swap_intern(struct Heap* heap, int index0, int index1);
+
+struct Heap* heap_create(Heap_compare_fp_t func_ptr)
+{
+  assert(func_ptr);
+  struct Heap* heap = safe_alloc(sizeof(struct Heap));
+  heap->array = safe_alloc(sizeof(void*) * DEFAULT_ARRAY_SIZE);
+  heap->allocated_size = DEFAULT_ARRAY_SIZE;
+  heap->size = 0;
+  heap->compare = func_ptr;
+  return heap;
+}
+
+void heap_destroy(struct Heap* heap)
+{
+  assert(heap);
+  free(heap->array);
+  heap->array = NULL;
+  free(heap);
+}
+
+void heap_push(struct Heap* heap, void* item)
+{
+  assert(heap);
+  if (heap->size >= heap->allocated_size) {
+    grow_heap_intern(heap);
+  }
+  heap->array[heap->size] = item;
+  sift_up_intern(heap, heap->size++);
+}
+
+void* heap_top(const struct Heap* heap)
+{
+  assert(heap);
+  return heap->size ? heap->array[0] : NULL;
+}
+
+void* heap_pop(struct Heap* heap)
+{
+  assert(heap);
+  if (!heap->size) {
+    return NULL;
+  }
+  void* item = heap->array[0];
+  heap->array[0] = heap->array[--heap->size];
+  heap->array[heap->size] = NULL;
+  sift_down_intern(heap, 0);
+  return item;
+}
+
+void* heap_find_arg(const struct Heap* heap, const void* arg_ptr, Heap_compare_arg_fp_t func_ptr)
+{
+  assert(heap);
+  for (int i = 0; i < heap->size; ++i) {
+    if (!func_ptr(arg_ptr, heap->array[i])) {
+      return heap->array[i];
+    }
+  }
+  return NULL;
+}
+
+int heap_remove_all_arg(struct Heap* heap, const void* arg_ptr, Heap_compare_arg_fp_t func_ptr,
+  Heap_for_each_fp_t destroy_fp)
+{
+  assert(heap);
+  int size = 0;
+  for (int i = 0; i < heap->size; ++i) {
+    if (func_ptr(arg_ptr, heap->array[i])) {
+      heap->array[size++] = heap->array[i];
+    } else if (destroy_fp) {
+      destroy_fp(heap->array[i]);
+    }
+  }
+  int removed = heap->size - size;
+  for (int i = size; i < heap->size; ++i) {
+    heap->array[i] = NULL;
+  }
+  heap->size = size;
+  if (removed) {
+    for (int i = heap->size / 2 - 1; i >= 0; --i) {
+      sift_down_intern(heap, i);
+    }
+  }
+  return removed;
+}
+
+int heap_size(const struct Heap* heap)
+{
+  assert(heap);
+  return heap->size;
+}
+
+void heap_for_each(const struct Heap* heap, Heap_for_each_fp_t func_ptr)
+{
+  assert(heap);
+  for (int i = 0; i < heap->size; ++i) {
+    func_ptr(heap->array[i]);
+  }
+}
+
+static void grow_heap_intern(struct Heap* heap)
+{
+  int new_allocated_size = GROW_FACTOR * heap->allocated_size;
+  void** new_array = safe_alloc(sizeof(void*) * new_allocated_size);
+  for (int i = 0; i < heap->size; ++i) {
+    new_array[i] = heap->array[i];
+  }
+  free(heap->array);
+  heap->array = new_array;
+  heap->allocated_size = new_allocated_size;
+}
+
+static void sift_up_intern(struct Heap* heap, int index)
+{
+  while (index > 0) {
+    int parent = (index - 1) / 2;
+    if (heap->compare(heap->array[index], heap->array[parent]) >= 0) {
+      return;
+    }
+    swap_intern(heap, index, parent);
+    index = parent;
+  }
+}
+
+static void sift_down_intern(struct Heap* heap, int index)
+{
+  for (;;) {
+    int smallest = index;
+    int left = 2 * index + 1;
+    int right = left + 1;
+    if (left < heap->size && heap->compare(heap->array[left], heap->array[smallest]) < 0) {
+      smallest = left;
+    }
+    if (right < heap->size && heap->compare(heap->array[right], heap->array[smallest]) < 0) {
+      smallest = right;
+    }
+    if (smallest == index) {
+      return;
+    }
+    swap_intern(heap, index, smallest);
+    index = smallest;
+  }
+}
+
+static void swap_intern(struct Heap* heap, int index0, int index1)
+{
+  void* item = heap->array[index0];
+  heap->array[index0] = heap->array[index1];
+  heap->array[index1] = item;
+}
@@ -0,0 +1,77 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+struct Heap;
+
+/*
+Type of function that compares two data pointers. Returns 0 when data_ptr0 is
+equal to data_ptr1, negative when data_ptr0 should be closer to the top of the
+heap than data_ptr1, and positive otherwise.
+*/
+typedef int (*Heap_compare_fp_t) (const void* data_ptr0, const void* data_ptr1);
+
+/*
+Type of function that compares the data pointed to by arg_ptr and data_ptr.
+Returns 0 when data_ptr matches arg_ptr. See List_compare_arg_fp_t.
+*/
+typedef int (*Heap_compare_arg_fp_t) (const void* arg_ptr, const void* data_ptr);
+
+/*
+Type of function used by apply.
+*/
+typedef void (*Heap_for_each_fp_t) (void* data);
+
+/*
+Create a new, empty min-heap ordered by the given compare function.
+*/
+struct Heap* heap_create(Heap_compare_fp_t func_ptr);
+
+/*
+Destroy the heap.
+Caller is responsible for deleting all pointed-to data before calling this function.
+*/
+void heap_destroy(struct Heap* heap);
+
+/*
+Add the given item to the heap.
+*/
+void heap_push(struct Heap* heap, void* item);
+
+/*
+Get the item at the top of the heap without removing it.
+Return NULL if the heap is empty.
+*/
+void* heap_top(const struct Heap* heap);
+
+/*
+Remove and return the item at the top of the heap.
+Return NULL if the heap is empty.
+*/
+void* heap_pop(struct Heap* heap);
+
+/*
+Return the first item found for which func_ptr returns 0, without removing it.
+Return NULL if there is no such item.
+*/
+void* heap_find_arg(const struct Heap* heap, const void* arg_ptr, Heap_compare_arg_fp_t func_ptr);
+
+/*
+Remove every item for which func_ptr returns 0 in a single pass and restore
+the heap order once, in O(n). destroy_fp is applied to each removed item if it
+isn't NULL. Return the number of items removed.
+*/
+int heap_remove_all_arg(struct Heap* heap, const void* arg_ptr, Heap_compare_arg_fp_t func_ptr,
+  Heap_for_each_fp_t destroy_fp);
+
+/*
+Get the size of the heap.
+*/
+int heap_size(const struct Heap* heap);
+
+/*
+Apply the supplied function to the data pointer in each item of the heap, in
+no particular order.
+*/
+void heap_for_each(const struct Heap* heap, Heap_for_each_fp_t func_ptr);
+
+#endif /*HEAP_H*/
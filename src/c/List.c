@@ -56,6 +56,23 @@ void list_add(struct List* list, void* item)
   list->array[list->size++] = item;
 }
 
+void list_insert(struct List* list, int index, void* item)
+{
+  assert(list);
+  if (!in_range(index, 0, list->size + 1)) {
+    APP_LOG(APP_LOG_LEVEL_ERROR, "invalid index");
+    return;
+  }
+  if (list->size >= list->allocated_size) {
+    grow_list_intern(list);
+  }
+  for (int i = list->size; i > index; --i) {
+    list->array[i] = list->array[i - 1];
+  }
+  list->array[index] = item;
+  ++list->size;
+}
+
 static void grow_list_intern(struct List* list)
 {
   int new_allocated_size = GROW_FACTOR * (list->size + 1);
@@ -106,8 +123,13 @@ void list_remove(struct List* list, int index)
 void list_remove_ptr(struct List* list, void* data_ptr)
 {
   assert(list);
-  assert(data_ptr >= *(list->array));
-  list_remove(list, data_ptr - *(list->array));
+  for (int i = 0; i < list->size; ++i) {
+    if (list->array[i] == data_ptr) {
+      list_remove(list, i);
+      return;
+    }
+  }
+  APP_LOG(APP_LOG_LEVEL_ERROR, "item not in list");
 }
 
 void list_for_each(const struct List* list, List_for_each_fp_t func_ptr)
@@ -135,6 +157,26 @@ void* list_find_arg(const struct List* list, const void* arg_ptr, List_compare_a
   return NULL;
 }
 
+int list_remove_all_arg(struct List* list, const void* arg_ptr, List_compare_arg_fp_t func_ptr,
+  List_for_each_fp_t destroy_fp)
+{
+  assert(list);
+  int size = 0;
+  for (int i = 0; i < list->size; ++i) {
+    if (func_ptr(arg_ptr, list->array[i])) {
+      list->array[size++] = list->array[i];
+    } else if (destroy_fp) {
+      destroy_fp(list->array[i]);
+    }
+  }
+  int removed = list->size - size;
+  for (int i = size; i < list->size; ++i) {
+    list->array[i] = NULL;
+  }
+  list->size = size;
+  return removed;
+}
+
 struct List* list_load(List_load_item_fp_t func_ptr)
 {
   assert(persist_exists(g_current_persist_key));
@@ -149,6 +191,6 @@ struct List* list_load(List_load_item_fp_t func_ptr)
 void list_save(const struct List* list, List_for_each_fp_t func_ptr)
 {
   assert(list);
-  persist_write_int(g_current_persist_key++, list->size);
+  persist_util_write_int(g_current_persist_key++, list->size);
   list_for_each(list, func_ptr);
 }
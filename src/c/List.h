@@ -26,6 +26,12 @@ Add the given item to the back of the list.
 */
 void list_add(struct List* list, void* item);
 
+/*
+Insert the given item before the item at the given index. An index equal to
+the size of the list adds the item to the back of the list.
+*/
+void list_insert(struct List* list, int index, void* item);
+
 /*
 Get the size of the list.
 Return -1 if an error occurs.
@@ -97,6 +103,14 @@ argument.
 */
 void* list_find_arg(const struct List* list, const void* arg_ptr, List_compare_arg_fp_t func_ptr);
 
+/*
+Remove every item for which func_ptr returns 0 in a single pass, keeping the
+order of the other items. destroy_fp is applied to each removed item if it
+isn't NULL. Return the number of items removed.
+*/
+int list_remove_all_arg(struct List* list, const void* arg_ptr, List_compare_arg_fp_t func_ptr,
+  List_for_each_fp_t destroy_fp);
+
 /*
 Type of function used to load items to be added to the list.
 A load function returns a pointer to an item to add to the list.
@@ -0,0 +1,52 @@
+#include "Model_events.h"
+#include "Utility.h"
+#include "globals.h"
+#include "assert.h"
+
+#include <pebble.h>
+
+// One per window that shows the app data
+#define MAX_SUBSCRIBERS 4
+
+struct Subscriber {
+  Model_event_fp_t func_ptr;
+  void* context;
+};
+
+static struct Subscriber s_subscribers[MAX_SUBSCRIBERS];
+
+int model_events_subscribe(Model_event_fp_t func_ptr, void* context)
+{
+  assert(func_ptr);
+  for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+    if (!s_subscribers[i].func_ptr) {
+      s_subscribers[i].func_ptr = func_ptr;
+      s_subscribers[i].context = context;
+      return i;
+    }
+  }
+  APP_LOG(APP_LOG_LEVEL_ERROR, "Too many model event subscribers");
+  return INVALID_INDEX;
+}
+
+void model_events_unsubscribe(int handle)
+{
+  if (!in_range(handle, 0, MAX_SUBSCRIBERS)) {
+    return;
+  }
+  s_subscribers[handle].func_ptr = NULL;
+  s_subscribers[handle].context = NULL;
+}
+
+void model_events_notify(enum Model_event event, const void* subject)
+{
+  struct Model_event_data event_data = {
+    .event = event,
+    .subject = subject
+  };
+  for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+    if (s_subscribers[i].func_ptr) {
+      s_subscribers[i].func_ptr(&event_data, s_subscribers[i].context);
+    }
+  }
+}
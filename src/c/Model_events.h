@@ -0,0 +1,35 @@
+#ifndef MODEL_EVENTS_H
+#define MODEL_EVENTS_H
+
+/*
+Tells windows what changed in the app data so they can update only what they
+show of it. App_data, Timer_group, Timer and Settings post an event after each
+change; windows subscribe while they're loaded.
+*/
+
+enum Model_event {
+  MODEL_EVENT_GROUP_ADDED,       // subject is the Timer_group
+  MODEL_EVENT_GROUP_REMOVED,     // subject is the Timer_group, not destroyed yet
+  MODEL_EVENT_TIMER_ADDED,       // subject is the Timer_group the timer was added to
+  MODEL_EVENT_TIMER_REMOVED,     // subject is the Timer_group the timer was removed from
+  MODEL_EVENT_TIMER_EDITED,      // subject is the Timer whose length changed
+  MODEL_EVENT_TIMER_STATE,       // subject is the Timer that was started, paused or reset
+  MODEL_EVENT_SETTINGS_CHANGED,  // subject is the Settings
+  MODEL_EVENT_INVALID
+};
+
+struct Model_event_data {
+  enum Model_event event;
+  const void* subject;
+};
+
+typedef void (*Model_event_fp_t) (const struct Model_event_data* event_data, void* context);
+
+// Return a subscription handle, or negative if there are too many subscribers
+int model_events_subscribe(Model_event_fp_t func_ptr, void* context);
+void model_events_unsubscribe(int handle);
+
+// Tell the subscribers that subject changed
+void model_events_notify(enum Model_event event, const void* subject);
+
+#endif /*MODEL_EVENTS_H*/
@@ -0,0 +1,123 @@
+#include "Nudge_policy.h"
+
+#define SECONDS_PER_MINUTE 60
+#define NUDGE_COUNT_UNLIMITED -1
+
+struct Nudge_policy {
+  int first_interval; // Seconds from the timer elapsing to the first nudge
+  int max_interval;   // Intervals double until they reach this
+  int max_count;      // Nudges in the series, or NUDGE_COUNT_UNLIMITED
+};
+
+static const struct Nudge_policy s_fixed_policy = {
+  SECONDS_PER_MINUTE, SECONDS_PER_MINUTE, NUDGE_COUNT_UNLIMITED
+};
+static const struct Nudge_policy s_backoff_policy = {
+  SECONDS_PER_MINUTE, 30 * SECONDS_PER_MINUTE, 10
+};
+static const struct Nudge_policy s_limited_policy = {
+  SECONDS_PER_MINUTE, SECONDS_PER_MINUTE, 5
+};
+static const struct Nudge_policy s_continuous_policy = {
+  10, 10, 30
+};
+
+// Return NULL if the style doesn't nudge
+static const struct Nudge_policy* get_policy(enum Vibrate_style vibrate_style);
+static int is_in_series(const struct Nudge_policy* policy, int nudge_index);
+// Return non-zero if the nudge is the first of its window of
+// NUDGE_MIN_WAKEUP_INTERVAL seconds after the timer elapsed
+static int is_first_in_window(enum Vibrate_style vibrate_style, int nudge_index, int offset);
+
+int nudge_policy_get_offset(enum Vibrate_style vibrate_style, int nudge_index)
+{
+  const struct Nudge_policy* policy = get_policy(vibrate_style);
+  if (!policy || !is_in_series(policy, nudge_index)) {
+    return -1;
+  }
+  // Step through the doubling intervals; the rest are all max_interval long
+  int offset = 0;
+  int interval = policy->first_interval;
+  int index = 0;
+  while (index <= nudge_index && interval < policy->max_interval) {
+    offset += interval;
+    interval = interval * 2 < policy->max_interval ? interval * 2 : policy->max_interval;
+    ++index;
+  }
+  return offset + (nudge_index - index + 1) * interval;
+}
+
+int nudge_policy_get_next_index(enum Vibrate_style vibrate_style, int elapsed)
+{
+  const struct Nudge_policy* policy = get_policy(vibrate_style);
+  if (!policy) {
+    return -1;
+  }
+  int offset = 0;
+  int interval = policy->first_interval;
+  int index = 0;
+  while (interval < policy->max_interval) {
+    if (offset + interval > elapsed) {
+      return is_in_series(policy, index) ? index : -1;
+    }
+    offset += interval;
+    interval = interval * 2 < policy->max_interval ? interval * 2 : policy->max_interval;
+    ++index;
+  }
+  if (elapsed >= offset) {
+    index += (elapsed - offset) / interval;
+  }
+  return is_in_series(policy, index) ? index : -1;
+}
+
+int nudge_policy_plan(enum Vibrate_style vibrate_style, int end_time, int nudge_index, int* times,
+  int max_times, int* next_index)
+{
+  int num_times = 0;
+  int index = nudge_index;
+  for (int offset = nudge_policy_get_offset(vibrate_style, index); offset >= 0;
+      offset = nudge_policy_get_offset(vibrate_style, ++index)) {
+    if (!is_first_in_window(vibrate_style, index, offset)) {
+      continue;
+    }
+    if (num_times == max_times) {
+      break;
+    }
+    times[num_times++] = end_time + offset;
+  }
+  *next_index = index;
+  return num_times;
+}
+
+static const struct Nudge_policy* get_policy(enum Vibrate_style vibrate_style)
+{
+  switch (vibrate_style) {
+    case VIBRATE_STYLE_NUDGE:
+      return &s_fixed_policy;
+    case VIBRATE_STYLE_NUDGE_BACKOFF:
+      return &s_backoff_policy;
+    case VIBRATE_STYLE_NUDGE_LIMITED:
+      return &s_limited_policy;
+    case VIBRATE_STYLE_CONTINUOUS:
+      return &s_continuous_policy;
+    case VIBRATE_STYLE_NONE: // intentional fall through
+    case VIBRATE_STYLE_INVALID: // intentional fall through
+    default:
+      return 0;
+  }
+}
+
+static int is_in_series(const struct Nudge_policy* policy, int nudge_index)
+{
+  return nudge_index >= 0 &&
+    (policy->max_count == NUDGE_COUNT_UNLIMITED || nudge_index < policy->max_count);
+}
+
+static int is_first_in_window(enum Vibrate_style vibrate_style, int nudge_index, int offset)
+{
+  if (nudge_index == 0) {
+    return 1;
+  }
+  int previous_offset = nudge_policy_get_offset(vibrate_style, nudge_index - 1);
+  return (offset - 1) / NUDGE_MIN_WAKEUP_INTERVAL > (previous_offset - 1) / NUDGE_MIN_WAKEUP_INTERVAL;
+}
@@ -0,0 +1,42 @@
+#ifndef NUDGE_POLICY_H
+#define NUDGE_POLICY_H
+
+/*
+Works out when an elapsed timer that waits for the user nudges them again,
+according to its group's vibrate style. The whole series follows from when the
+timer elapsed, so it can be planned up front and resumed after the app was
+closed. Doesn't depend on the Pebble SDK.
+*/
+
+#include "Settings.h"
+
+// Number of nudges of a series that are kept registered as wakeups
+#define NUDGE_PLAN_LENGTH 5
+// Wakeups launch the app, so while it's closed a series launches it at most
+// once in each window of this many seconds after the timer elapsed
+#define NUDGE_MIN_WAKEUP_INTERVAL 60
+
+/*
+Return the seconds after the timer elapsed at which the nudge at nudge_index
+(counting from zero) happens. Return negative if the series has no such nudge.
+*/
+int nudge_policy_get_offset(enum Vibrate_style vibrate_style, int nudge_index);
+
+/*
+Return the index of the first nudge that happens more than elapsed seconds
+after the timer elapsed. Return negative if the series is over.
+*/
+int nudge_policy_get_next_index(enum Vibrate_style vibrate_style, int elapsed);
+
+/*
+Fill times with up to max_times nudges to register as wakeups, starting with
+the one at nudge_index, of a timer that elapsed at end_time. Only the first
+nudge in each window of NUDGE_MIN_WAKEUP_INTERVAL seconds is planned; the others
+happen while the app is open only. Set next_index to the nudge the next plan
+starts at, which is past the end of the series if it's over. Return the number
+of times filled.
+*/
+int nudge_policy_plan(enum Vibrate_style vibrate_style, int end_time, int nudge_index, int* times,
+  int max_times, int* next_index);
+
+#endif /*NUDGE_POLICY_H*/
@@ -0,0 +1,193 @@
+#include "Run_state.h"
+#include "Schedule_planner.h"
+#include "Nudge_policy.h"
+
+static int get_length(const struct Run_config* config, int timer_index);
+static int get_time(const struct Run_env* env);
+static void emit(const struct Run_env* env, enum Run_event event, int timer_index, int previous_timer_index,
+  int due_time);
+static void handle_end(struct Run_state* state, const struct Run_config* config, const struct Run_env* env,
+  int now);
+
+struct Run_state run_state_running(int timer_index, int end_time)
+{
+  return (struct Run_state) {
+    .phase = RUN_PHASE_RUNNING,
+    .timer_index = timer_index,
+    .end_time = end_time,
+    .remaining = 0,
+    .nudge_index = -1
+  };
+}
+
+struct Run_state run_state_elapsed(int timer_index, int end_time, int nudge_index)
+{
+  return (struct Run_state) {
+    .phase = RUN_PHASE_ELAPSED,
+    .timer_index = timer_index,
+    .end_time = end_time,
+    .remaining = 0,
+    .nudge_index = nudge_index
+  };
+}
+
+struct Run_state run_state_relaunch(const struct Run_config* config, int timer_index, int end_time,
+  int fired_time, int now)
+{
+  if (fired_time == end_time) {
+    return run_state_running(timer_index, end_time);
+  }
+  // The nudge at fired_time, or the first one still to come
+  int elapsed = fired_time > end_time ? fired_time - end_time - 1 : now - end_time;
+  return run_state_elapsed(timer_index, end_time, nudge_policy_get_next_index(config->vibrate_style, elapsed));
+}
+
+void run_state_reset(struct Run_state* state)
+{
+  state->phase = RUN_PHASE_STOPPED;
+  state->end_time = 0;
+  state->remaining = 0;
+  state->nudge_index = -1;
+}
+
+void run_state_start_timer(struct Run_state* state, const struct Run_config* config, int timer_index,
+  const struct Run_env* env)
+{
+  *state = run_state_running(timer_index, get_time(env) + get_length(config, timer_index));
+}
+
+void run_state_select(struct Run_state* state, const struct Run_config* config, const struct Run_env* env)
+{
+  int now = get_time(env);
+  switch (state->phase) {
+    case RUN_PHASE_RUNNING:
+      if (state->end_time > now) {
+        state->phase = RUN_PHASE_PAUSED;
+        state->remaining = state->end_time - now;
+        return;
+      }
+      // The timer elapsed before its deadline was handled
+      // intentional fall through
+    case RUN_PHASE_ELAPSED: {
+      int previous_timer_index = state->timer_index;
+      int next_timer_index = schedule_planner_get_next_index(config->repeat_style, config->progress_style,
+        config->num_timers, state->timer_index);
+      if (next_timer_index < 0) {
+        run_state_reset(state);
+        return;
+      }
+      run_state_start_timer(state, config, next_timer_index, env);
+      emit(env, RUN_EVENT_PROGRESS, next_timer_index, previous_timer_index, now);
+      return;
+    }
+    case RUN_PHASE_PAUSED:
+      *state = run_state_running(state->timer_index, now + state->remaining);
+      return;
+    case RUN_PHASE_STOPPED: // intentional fall through
+    default:
+      run_state_start_timer(state, config, state->timer_index, env);
+      return;
+  }
+}
+
+int run_state_get_deadline(const struct Run_state* state, const struct Run_config* config)
+{
+  switch (state->phase) {
+    case RUN_PHASE_RUNNING:
+      return state->end_time;
+    case RUN_PHASE_ELAPSED: {
+      int offset = nudge_policy_get_offset(config->vibrate_style, state->nudge_index);
+      return offset < 0 ? RUN_NO_DEADLINE : state->end_time + offset;
+    }
+    case RUN_PHASE_STOPPED: // intentional fall through
+    case RUN_PHASE_PAUSED: // intentional fall through
+    default:
+      return RUN_NO_DEADLINE;
+  }
+}
+
+int run_state_handle_deadline(struct Run_state* state, const struct Run_config* config,
+  const struct Run_env* env)
+{
+  int deadline = run_state_get_deadline(state, config);
+  int now = get_time(env);
+  if (deadline == RUN_NO_DEADLINE || deadline > now) {
+    return 0;
+  }
+  if (state->phase == RUN_PHASE_RUNNING) {
+    handle_end(state, config, env, now);
+    return 1;
+  }
+  emit(env, RUN_EVENT_NUDGE, state->timer_index, state->timer_index, deadline);
+  // Nudges that were missed aren't made up for
+  ++state->nudge_index;
+  if (nudge_policy_get_offset(config->vibrate_style, state->nudge_index) < 0) {
+    state->nudge_index = -1;
+  }
+  return 1;
+}
+
+static int get_length(const struct Run_config* config, int timer_index)
+{
+  return config->prefix_sums[timer_index + 1] - config->prefix_sums[timer_index];
+}
+
+static int get_time(const struct Run_env* env)
+{
+  return env->clock(env->clock_context);
+}
+
+static void emit(const struct Run_env* env, enum Run_event event, int timer_index, int previous_timer_index,
+  int due_time)
+{
+  if (!env->sink) {
+    return;
+  }
+  struct Run_event_data event_data = {
+    .event = event,
+    .timer_index = timer_index,
+    .previous_timer_index = previous_timer_index,
+    .due_time = due_time
+  };
+  env->sink(&event_data, env->sink_context);
+}
+
+static void handle_end(struct Run_state* state, const struct Run_config* config, const struct Run_env* env,
+  int now)
+{
+  int timer_index = state->timer_index;
+  int end_time = state->end_time;
+  emit(env, RUN_EVENT_ELAPSED, timer_index, timer_index, end_time);
+  if (config->progress_style != PROGRESS_STYLE_AUTO) {
+    // Wait for the user, picking the nudge series up where it is by now
+    *state = run_state_elapsed(timer_index, end_time,
+      nudge_policy_get_next_index(config->vibrate_style, now - end_time));
+    return;
+  }
+  // Find where the group is now. Usually that's the next timer, but the
+  // deadline may have been handled after several timers elapsed.
+  int start_time = end_time - get_length(config, timer_index);
+  struct Schedule_position position;
+  schedule_planner_locate(config->prefix_sums, config->num_timers, config->repeat_style, config->progress_style,
+    timer_index, now - start_time, &position);
+  int next_end_time = end_time;
+  if (position.remaining > 0) {
+    next_end_time = now + position.remaining;
+  } else if (position.timer_index != timer_index) {
+    // The group stopped progressing; work out when its last timer elapsed
+    next_end_time = start_time + config->prefix_sums[position.timer_index + 1] -
+      config->prefix_sums[timer_index];
+  }
+  if (position.timer_index == timer_index && next_end_time == end_time) {
+    // The group doesn't progress; the alert was the last thing it does
+    *state = run_state_elapsed(timer_index, end_time, -1);
+    return;
+  }
+  if (next_end_time > now) {
+    *state = run_state_running(position.timer_index, next_end_time);
+  } else {
+    // The group finished before the deadline was handled, and this was its alert
+    *state = run_state_elapsed(position.timer_index, next_end_time, -1);
+  }
+  emit(env, RUN_EVENT_PROGRESS, position.timer_index, timer_index, end_time);
+}
@@ -0,0 +1,103 @@
+#ifndef RUN_STATE_H
+#define RUN_STATE_H
+
+/*
+The run state machine of one timer group: which timer runs, when it elapses,
+how the group progresses and when an elapsed timer nudges the user. The clock
+and the events the machine emits are injected, so the scheduler drives it with
+the real time and tools/run_simulator.c drives it over virtual time.
+Doesn't depend on the Pebble SDK.
+*/
+
+#include "Settings.h"
+
+// What the machine needs to know about a group
+struct Run_config {
+  const int* prefix_sums; // As filled by schedule_planner_fill_prefix_sums
+  int num_timers;
+  enum Repeat_style repeat_style;
+  enum Progress_style progress_style;
+  enum Vibrate_style vibrate_style;
+};
+
+enum Run_phase {
+  RUN_PHASE_STOPPED, // The timer at timer_index is reset
+  RUN_PHASE_RUNNING, // The timer at timer_index elapses at end_time
+  RUN_PHASE_PAUSED,  // The timer at timer_index has remaining seconds left
+  RUN_PHASE_ELAPSED  // The timer at timer_index elapsed at end_time and waits for the user
+};
+
+struct Run_state {
+  enum Run_phase phase;
+  int timer_index;
+  int end_time;    // Seconds since the epoch. Running and elapsed only.
+  int remaining;   // Paused only
+  int nudge_index; // Elapsed only: next nudge of the series, negative if it's over
+};
+
+enum Run_event {
+  RUN_EVENT_ELAPSED,  // The timer elapsed; alert the user
+  RUN_EVENT_NUDGE,    // The elapsed timer nudges the user again; alert them
+  RUN_EVENT_PROGRESS, // The group moved from previous_timer_index to timer_index
+  RUN_EVENT_INVALID
+};
+
+struct Run_event_data {
+  enum Run_event event;
+  int timer_index;
+  int previous_timer_index;
+  int due_time; // When the event should have happened, in seconds since the epoch
+};
+
+// Return the current time in seconds since the epoch
+typedef int (*Run_clock_fp_t)(void* context);
+typedef void (*Run_event_fp_t)(const struct Run_event_data* event_data, void* context);
+
+struct Run_env {
+  Run_clock_fp_t clock;
+  void* clock_context;
+  Run_event_fp_t sink;
+  void* sink_context;
+};
+
+#define RUN_NO_DEADLINE -1
+
+// States of a timer that runs until end_time, and of one that elapsed at
+// end_time and nudges next at nudge_index
+struct Run_state run_state_running(int timer_index, int end_time);
+struct Run_state run_state_elapsed(int timer_index, int end_time, int nudge_index);
+/*
+State of a timer that ran past end_time and waits for the user, when the app
+launches at now. Whether its alert already happened isn't saved, so only the
+wakeup that launched the app decides: fired_time is when that wakeup was due
+for the timer, or RUN_NO_DEADLINE. If it was due at end_time the elapse is
+still to be alerted, if it was due at a nudge that nudge is, and otherwise
+nothing is due before the next nudge, so a launch never replays an alert.
+*/
+struct Run_state run_state_relaunch(const struct Run_config* config, int timer_index, int end_time,
+  int fired_time, int now);
+
+// Reset the current timer, or switch to the timer at timer_index and start it
+void run_state_reset(struct Run_state* state);
+void run_state_start_timer(struct Run_state* state, const struct Run_config* config, int timer_index,
+  const struct Run_env* env);
+
+/*
+Same as the select button of the countdown window: an elapsed timer moves the
+group on to its next timer, or resets if there is none; a running timer
+pauses; anything else starts.
+*/
+void run_state_select(struct Run_state* state, const struct Run_config* config, const struct Run_env* env);
+
+// Return when the machine has to handle something next, or RUN_NO_DEADLINE
+int run_state_get_deadline(const struct Run_state* state, const struct Run_config* config);
+
+/*
+Handle whatever is due by now: the running timer elapsing, which may progress
+the group past several timers if the deadline was handled late, or the next
+nudge of an elapsed timer. Return non-zero if anything was due.
+*/
+int run_state_handle_deadline(struct Run_state* state, const struct Run_config* config,
+  const struct Run_env* env);
+
+#endif /*RUN_STATE_H*/
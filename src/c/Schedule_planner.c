@@ -0,0 +1,139 @@
+#include "Schedule_planner.h"
+
+// Return the last timer that starts at or before offset, which must be in
+// [0, prefix_sums[num_timers])
+static int find_timer_index(const int* prefix_sums, int num_timers, int offset);
+static int get_length(const int* prefix_sums, int timer_index);
+
+void schedule_planner_fill_prefix_sums(const int* lengths, int num_timers, int* prefix_sums)
+{
+  prefix_sums[0] = 0;
+  for (int i = 0; i < num_timers; ++i) {
+    prefix_sums[i + 1] = prefix_sums[i] + lengths[i];
+  }
+}
+
+int schedule_planner_get_next_index(enum Repeat_style repeat_style, enum Progress_style progress_style,
+  int num_timers, int timer_index)
+{
+  if (num_timers <= 0) {
+    return -1;
+  }
+  if (progress_style != PROGRESS_STYLE_AUTO && progress_style != PROGRESS_STYLE_WAIT_FOR_USER) {
+    // Can't progress; repeat the same timer and don't automatically start
+    return -1;
+  }
+  switch (repeat_style) {
+    case REPEAT_STYLE_NONE:
+      if (timer_index >= num_timers - 1) {
+        return -1;
+      }
+      return timer_index + 1;
+    case REPEAT_STYLE_SINGLE:
+      return timer_index;
+    case REPEAT_STYLE_GROUP:
+      if (timer_index >= num_timers - 1) {
+        return 0;
+      }
+      return timer_index + 1;
+    case REPEAT_STYLE_INVALID: // intentional fall through
+    default:
+      return -1;
+  }
+}
+
+void schedule_planner_locate(const int* prefix_sums, int num_timers, enum Repeat_style repeat_style,
+  enum Progress_style progress_style, int timer_index, int elapsed, struct Schedule_position* position)
+{
+  position->cycle = 0;
+  position->timer_index = timer_index;
+  position->remaining = 0;
+  if (!prefix_sums || timer_index < 0 || timer_index >= num_timers) {
+    return;
+  }
+  int length = get_length(prefix_sums, timer_index);
+  if (elapsed < 0) {
+    elapsed = 0;
+  }
+  if (progress_style != PROGRESS_STYLE_AUTO || (repeat_style == REPEAT_STYLE_SINGLE && length <= 0)) {
+    // The timer stays put once it elapses
+    position->remaining = elapsed < length ? length - elapsed : 0;
+    return;
+  }
+  int total = prefix_sums[num_timers];
+  // Offset into the group, measured from the start of its first timer
+  int offset = prefix_sums[timer_index] + elapsed;
+  switch (repeat_style) {
+    case REPEAT_STYLE_SINGLE:
+      position->cycle = elapsed / length;
+      position->remaining = length - elapsed % length;
+      return;
+    case REPEAT_STYLE_NONE:
+      if (offset >= total) {
+        // Finished on the last timer
+        position->timer_index = num_timers - 1;
+        return;
+      }
+      break;
+    case REPEAT_STYLE_GROUP:
+      if (total <= 0) {
+        return;
+      }
+      position->cycle = offset / total;
+      offset %= total;
+      break;
+    case REPEAT_STYLE_INVALID: // intentional fall through
+    default:
+      position->remaining = elapsed < length ? length - elapsed : 0;
+      return;
+  }
+  position->timer_index = find_timer_index(prefix_sums, num_timers, offset);
+  position->remaining = prefix_sums[position->timer_index + 1] - offset;
+}
+
+int schedule_planner_plan(const int* prefix_sums, int num_timers, enum Repeat_style repeat_style,
+  enum Progress_style progress_style, int timer_index, int end_time,
+  struct Planned_transition* transitions, int max_transitions)
+{
+  if (!prefix_sums || !transitions || timer_index < 0 || timer_index >= num_timers) {
+    return 0;
+  }
+  int num_transitions = 0;
+  while (num_transitions < max_transitions) {
+    transitions[num_transitions].timer_index = timer_index;
+    transitions[num_transitions].time = end_time;
+    ++num_transitions;
+    if (progress_style != PROGRESS_STYLE_AUTO) {
+      // The user has to start the next timer
+      break;
+    }
+    timer_index = schedule_planner_get_next_index(repeat_style, progress_style, num_timers, timer_index);
+    if (timer_index < 0) {
+      break;
+    }
+    end_time += get_length(prefix_sums, timer_index);
+  }
+  return num_transitions;
+}
+
+static int find_timer_index(const int* prefix_sums, int num_timers, int offset)
+{
+  // Binary search for the last start at or before offset. Skips zero length
+  // timers, which end as soon as they start.
+  int low = 0;
+  int high = num_timers - 1;
+  while (low < high) {
+    int mid = (low + high + 1) / 2;
+    if (prefix_sums[mid] <= offset) {
+      low = mid;
+    } else {
+      high = mid - 1;
+    }
+  }
+  return low;
+}
+
+static int get_length(const int* prefix_sums, int timer_index)
+{
+  return prefix_sums[timer_index + 1] - prefix_sums[timer_index];
+}
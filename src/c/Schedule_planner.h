@@ -0,0 +1,58 @@
+#ifndef SCHEDULE_PLANNER_H
+#define SCHEDULE_PLANNER_H
+
+/*
+Works out when the timers of a group will elapse from the group's settings and
+timer lengths, so a routine can keep going while the app isn't running.
+Doesn't depend on the Pebble SDK.
+*/
+
+#include "Settings.h"
+
+// Number of upcoming transitions of a group that are kept registered as wakeups
+#define SCHEDULE_PLAN_LENGTH 3
+
+struct Planned_transition {
+  int timer_index; // Timer that elapses
+  int time;        // When it elapses, in seconds since the epoch
+};
+
+struct Schedule_position {
+  int cycle;       // Number of times the group wrapped around to its first timer
+  int timer_index; // Timer that is running
+  int remaining;   // Seconds until it elapses. Zero if the group finished.
+};
+
+/*
+Fill prefix_sums (which must hold num_timers + 1 entries) so that
+prefix_sums[i] is the total length of the timers before timer i, and
+prefix_sums[num_timers] is the length of the whole group.
+*/
+void schedule_planner_fill_prefix_sums(const int* lengths, int num_timers, int* prefix_sums);
+
+/*
+Return the index of the timer that runs after the timer at timer_index elapses.
+Return negative if the group doesn't progress.
+*/
+int schedule_planner_get_next_index(enum Repeat_style repeat_style, enum Progress_style progress_style,
+  int num_timers, int timer_index);
+
+/*
+Find where a group is once the timer at timer_index has been running for
+elapsed seconds, without stepping through the timers in between. Takes
+O(log num_timers) no matter how many times the group repeated.
+*/
+void schedule_planner_locate(const int* prefix_sums, int num_timers, enum Repeat_style repeat_style,
+  enum Progress_style progress_style, int timer_index, int elapsed, struct Schedule_position* position);
+
+/*
+Fill transitions with up to max_transitions upcoming timer ends of a group
+whose timer at timer_index elapses at end_time, starting with that one. Later
+transitions are only planned when the group progresses automatically.
+Return the number of transitions filled.
+*/
+int schedule_planner_plan(const int* prefix_sums, int num_timers, enum Repeat_style repeat_style,
+  enum Progress_style progress_style, int timer_index, int end_time,
+  struct Planned_transition* transitions, int max_transitions);
+
+#endif /*SCHEDULE_PLANNER_H*/
@@ -0,0 +1,650 @@
+#include "Scheduler.h"
+#include "Heap.h"
+#include "List.h"
+#include "App_data.h"
+#include "Timer.h"
+#include "Timer_group.h"
+#include "Settings.h"
+#include "Schedule_planner.h"
+#include "Nudge_policy.h"
+#include "Run_state.h"
+#include "Utility.h"
+#include "Wakeup_manager.h"
+#include "Work_queue.h"
+#include "globals.h"
+#include "assert.h"
+#include "profile.h"
+#include "trace.h"
+#include "alert_latency.h"
+#include "energy.h"
+
+#include <pebble.h>
+
+#define MAX_SUBSCRIBERS 4
+#define NOT_ARMED -1
+
+enum Deadline_type {
+  DEADLINE_TYPE_END,   // The timer elapses
+  DEADLINE_TYPE_NUDGE  // The elapsed timer should nudge the user again
+};
+
+struct Deadline {
+  int timer_id;
+  int time; // Seconds since the epoch
+  enum Deadline_type type;
+  // Nudges only
+  int nudge_index;        // Which nudge of the series this is
+  int planned_nudges_end; // Where the registered wakeups of the series end
+};
+
+struct Subscriber {
+  Scheduler_event_fp_t func_ptr;
+  void* context;
+};
+
+static struct Heap* s_deadlines = NULL;
+static AppTimer* s_app_timer_handle = NULL;
+static int s_armed_time = NOT_ARMED;
+static struct Subscriber s_subscribers[MAX_SUBSCRIBERS];
+
+// Deadlines
+static struct Deadline* push_deadline(int timer_id, int time, enum Deadline_type type);
+static void remove_deadlines(int timer_id);
+// Remove the deadlines of all the group's timers in one pass
+static void remove_group_deadlines(const struct Timer_group* timer_group);
+// Push the deadlines of the group's running timers that haven't finished
+static void push_group_deadlines(const struct Timer_group* timer_group);
+// Push the deadline of a timer that ran past its end and waits for the user, as
+// it is at launch. fired_time is when the launch wakeup was due for the timer,
+// or RUN_NO_DEADLINE.
+static void push_relaunch_deadline(const struct Timer* timer, const struct Timer_group* timer_group,
+  int fired_time);
+static int deadline_compare(const struct Deadline* deadline0, const struct Deadline* deadline1);
+static int deadline_compare_timer_id(const int* timer_id, const struct Deadline* deadline);
+static int deadline_compare_timer_id_set(const struct Timer_id_set* timer_id_set, const struct Deadline* deadline);
+static void deadline_destroy(struct Deadline* deadline);
+
+// App timer
+static void arm_app_timer();
+static void app_timer_handler(void* data);
+
+// Helpers
+static void handle_deadline(const struct Deadline* deadline);
+static void wakeup_fired_handler(int timer_id, int wakeup_time, void* context);
+// Run state machine
+static int run_clock(void* context);
+static void run_event_handler(const struct Run_event_data* event_data, void* context);
+// Keep the progress event of a select for once the timers reflect it
+static void select_event_handler(const struct Run_event_data* event_data, void* context);
+// Vibrate for an alert that was due at due_time
+static void alert(int timer_id, int due_time);
+static void schedule_wakeups(const struct Timer* timer);
+// Bring the timer's wakeups in line with its deadlines once the current event
+// has been handled. Repeated requests for the same timer are coalesced.
+static void defer_wakeup_sync(int timer_id);
+static void sync_wakeups(void* context);
+// Cancel the wakeups of the timers in the set, then free the set
+static void cancel_wakeups(void* context);
+// Push the deadline of the nudge at nudge_index of an elapsed timer that waits
+// for the user. The wakeup table is only touched when the series runs past
+// planned_nudges_end or is over.
+static void schedule_nudge(const struct Timer* timer, const struct Timer_group* timer_group,
+  int nudge_index, int planned_nudges_end);
+static bool is_finished(const struct Timer_group* timer_group, int timer_index);
+static void notify(enum Scheduler_event event, int timer_id, int previous_timer_id);
+
+void scheduler_init()
+{
+  if (s_deadlines) {
+    return;
+  }
+  s_deadlines = heap_create((Heap_compare_fp_t) deadline_compare);
+  struct List* timer_groups = app_data_get_timer_groups(app_data_get());
+  struct Wakeup_manager* wakeup_manager = app_data_get_wakeup_manager(app_data_get());
+  for (int i = 0; i < list_size(timer_groups); ++i) {
+    // Deadlines in the past fire as soon as the event loop starts, which
+    // catches their groups up and plans their wakeups again
+    push_group_deadlines(list_get(timer_groups, i));
+  }
+  // Before the table changes, so the wakeup that fired is still the armed one
+  wakeup_manager_handle_wakeup(wakeup_manager, wakeup_fired_handler, NULL);
+  for (int i = 0; i < list_size(timer_groups); ++i) {
+    // Extend the plan of upcoming transitions
+    wakeup_manager_schedule_group(wakeup_manager, list_get(timer_groups, i));
+  }
+  arm_app_timer();
+}
+
+void scheduler_deinit()
+{
+  if (!s_deadlines) {
+    return;
+  }
+  if (s_app_timer_handle) {
+    app_timer_cancel(s_app_timer_handle);
+    s_app_timer_handle = NULL;
+  }
+  s_armed_time = NOT_ARMED;
+  heap_for_each(s_deadlines, (Heap_for_each_fp_t) deadline_destroy);
+  heap_destroy(s_deadlines);
+  s_deadlines = NULL;
+}
+
+int scheduler_subscribe(Scheduler_event_fp_t func_ptr, void* context)
+{
+  assert(func_ptr);
+  for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+    if (!s_subscribers[i].func_ptr) {
+      s_subscribers[i].func_ptr = func_ptr;
+      s_subscribers[i].context = context;
+      return i;
+    }
+  }
+  APP_LOG(APP_LOG_LEVEL_ERROR, "Too many scheduler subscribers");
+  return INVALID_INDEX;
+}
+
+void scheduler_unsubscribe(int handle)
+{
+  if (!in_range(handle, 0, MAX_SUBSCRIBERS)) {
+    return;
+  }
+  s_subscribers[handle].func_ptr = NULL;
+  s_subscribers[handle].context = NULL;
+}
+
+void scheduler_timer_start(struct Timer* timer)
+{
+  assert(timer);
+  timer_start(timer);
+  scheduler_timer_add(timer);
+}
+
+void scheduler_timer_pause(struct Timer* timer)
+{
+  assert(timer);
+  timer_pause(timer);
+  scheduler_timer_remove(timer);
+}
+
+void scheduler_timer_reset(struct Timer* timer)
+{
+  assert(timer);
+  timer_reset(timer);
+  scheduler_timer_remove(timer);
+}
+
+struct Timer* scheduler_timer_select(struct Timer* timer)
+{
+  assert(s_deadlines);
+  assert(timer);
+  struct App_data* app_data = app_data_get();
+  struct Timer_group* timer_group = app_data_get_timer_group(app_data,
+    app_data_get_timer_group_index_by_timer_id(app_data, timer_get_id(timer)));
+  assert(timer_group);
+  struct Run_config config;
+  timer_group_get_run_config(timer_group, &config);
+  int timer_index = timer_group_get_timer_index(timer_group, timer_get_id(timer));
+  timer_update(timer);
+  struct Run_state state = run_state_running(timer_index, timer_get_end_time(timer));
+  if (timer_is_paused(timer)) {
+    state.phase = RUN_PHASE_PAUSED;
+    state.remaining = timer_get_remaining_seconds(timer);
+  } else if (!timer_is_running(timer)) {
+    run_state_reset(&state);
+  }
+  struct Run_event_data progress = { .event = RUN_EVENT_INVALID };
+  struct Run_env env = {
+    .clock = run_clock,
+    .clock_context = NULL,
+    .sink = select_event_handler,
+    .sink_context = &progress
+  };
+  run_state_select(&state, &config, &env);
+  if (progress.event == RUN_EVENT_PROGRESS) {
+    scheduler_timer_reset(timer);
+    struct Timer* next_timer = timer_group_get_timer(timer_group, state.timer_index);
+    timer_reset(next_timer);
+    scheduler_timer_start(next_timer);
+    notify(SCHEDULER_EVENT_PROGRESS, timer_get_id(next_timer), timer_get_id(timer));
+    return next_timer;
+  }
+  switch (state.phase) {
+    case RUN_PHASE_RUNNING:
+      scheduler_timer_start(timer);
+      break;
+    case RUN_PHASE_PAUSED:
+      scheduler_timer_pause(timer);
+      break;
+    case RUN_PHASE_STOPPED: // intentional fall through
+    case RUN_PHASE_ELAPSED: // intentional fall through
+    default:
+      scheduler_timer_reset(timer);
+      break;
+  }
+  return timer;
+}
+
+void scheduler_timer_add(const struct Timer* timer)
+{
+  assert(s_deadlines);
+  assert(timer);
+  if (!timer_is_running(timer)) {
+    return;
+  }
+  remove_deadlines(timer_get_id(timer));
+  push_deadline(timer_get_id(timer), timer_get_end_time(timer), DEADLINE_TYPE_END);
+  defer_wakeup_sync(timer_get_id(timer));
+  arm_app_timer();
+}
+
+void scheduler_timer_remove(const struct Timer* timer)
+{
+  assert(s_deadlines);
+  assert(timer);
+  remove_deadlines(timer_get_id(timer));
+  defer_wakeup_sync(timer_get_id(timer));
+  arm_app_timer();
+}
+
+void scheduler_group_start(struct Timer_group* timer_group, int timer_index)
+{
+  assert(timer_group);
+  assert(in_range(timer_index, 0, timer_group_size(timer_group)));
+  for (int i = 0; i < timer_group_size(timer_group); ++i) {
+    timer_reset(timer_group_get_timer(timer_group, i));
+  }
+  timer_start(timer_group_get_timer(timer_group, timer_index));
+  scheduler_group_add(timer_group);
+}
+
+void scheduler_group_add(const struct Timer_group* timer_group)
+{
+  assert(s_deadlines);
+  assert(timer_group);
+  remove_group_deadlines(timer_group);
+  push_group_deadlines(timer_group);
+  wakeup_manager_schedule_group(app_data_get_wakeup_manager(app_data_get()), timer_group);
+  arm_app_timer();
+}
+
+void scheduler_group_remove(const struct Timer_group* timer_group)
+{
+  assert(s_deadlines);
+  assert(timer_group);
+  remove_group_deadlines(timer_group);
+  // The group is usually destroyed right after, so keep its timer IDs
+  struct Timer_id_set* timer_id_set = safe_alloc(sizeof(struct Timer_id_set));
+  timer_group_get_timer_id_set(timer_group, timer_id_set);
+  work_queue_defer(cancel_wakeups, timer_id_set);
+  arm_app_timer();
+}
+
+// Deadlines
+static struct Deadline* push_deadline(int timer_id, int time, enum Deadline_type type)
+{
+  struct Deadline* deadline = safe_alloc(sizeof(struct Deadline));
+  deadline->timer_id = timer_id;
+  deadline->time = time;
+  deadline->type = type;
+  deadline->nudge_index = 0;
+  deadline->planned_nudges_end = 0;
+  heap_push(s_deadlines, deadline);
+  return deadline;
+}
+
+static void remove_deadlines(int timer_id)
+{
+  heap_remove_all_arg(s_deadlines, &timer_id, (Heap_compare_arg_fp_t) deadline_compare_timer_id,
+    (Heap_for_each_fp_t) deadline_destroy);
+}
+
+static void remove_group_deadlines(const struct Timer_group* timer_group)
+{
+  struct Timer_id_set timer_id_set;
+  timer_group_get_timer_id_set(timer_group, &timer_id_set);
+  heap_remove_all_arg(s_deadlines, &timer_id_set, (Heap_compare_arg_fp_t) deadline_compare_timer_id_set,
+    (Heap_for_each_fp_t) deadline_destroy);
+  timer_id_set_clear(&timer_id_set);
+}
+
+static void push_group_deadlines(const struct Timer_group* timer_group)
+{
+  for (int i = 0; i < timer_group_size(timer_group); ++i) {
+    struct Timer* timer = timer_group_get_timer(timer_group, i);
+    if (!timer_is_running(timer)) {
+      continue;
+    }
+    timer_update(timer);
+    if (timer_is_elapsed(timer) && is_finished(timer_group, i)) {
+      // Already alerted when it elapsed; nothing left to do
+      continue;
+    }
+    if (timer_is_elapsed(timer) &&
+        settings_get_progress_style(timer_group_get_settings(timer_group)) != PROGRESS_STYLE_AUTO) {
+      // It may have alerted already, so only the launch wakeup can make it due
+      push_relaunch_deadline(timer, timer_group, RUN_NO_DEADLINE);
+      continue;
+    }
+    push_deadline(timer_get_id(timer), timer_get_end_time(timer), DEADLINE_TYPE_END);
+  }
+}
+
+static void push_relaunch_deadline(const struct Timer* timer, const struct Timer_group* timer_group,
+  int fired_time)
+{
+  struct Run_config config;
+  timer_group_get_run_config(timer_group, &config);
+  int timer_index = timer_group_get_timer_index(timer_group, timer_get_id(timer));
+  struct Run_state state = run_state_relaunch(&config, timer_index, timer_get_end_time(timer), fired_time,
+    time(NULL));
+  int deadline_time = run_state_get_deadline(&state, &config);
+  if (deadline_time == RUN_NO_DEADLINE) {
+    return;
+  }
+  if (state.phase == RUN_PHASE_RUNNING) {
+    push_deadline(timer_get_id(timer), deadline_time, DEADLINE_TYPE_END);
+    return;
+  }
+  struct Deadline* deadline = push_deadline(timer_get_id(timer), deadline_time, DEADLINE_TYPE_NUDGE);
+  deadline->nudge_index = state.nudge_index;
+  // How much of the series is still registered isn't known, so it's planned
+  // again from the nudge after this one
+  deadline->planned_nudges_end = state.nudge_index;
+}
+
+static int deadline_compare(const struct Deadline* deadline0, const struct Deadline* deadline1)
+{
+  assert(deadline0);
+  assert(deadline1);
+  return deadline0->time - deadline1->time;
+}
+
+static int deadline_compare_timer_id(const int* timer_id, const struct Deadline* deadline)
+{
+  assert(timer_id);
+  assert(deadline);
+  return *timer_id - deadline->timer_id;
+}
+
+static int deadline_compare_timer_id_set(const struct Timer_id_set* timer_id_set, const struct Deadline* deadline)
+{
+  assert(timer_id_set);
+  assert(deadline);
+  return timer_id_set_contains(timer_id_set, deadline->timer_id) ? 0 : 1;
+}
+
+static void deadline_destroy(struct Deadline* deadline)
+{
+  free(deadline);
+}
+
+// App timer
+static void arm_app_timer()
+{
+  struct Deadline* deadline = heap_top(s_deadlines);
+  if (deadline && s_app_timer_handle && deadline->time == s_armed_time) {
+    // Already armed for the earliest deadline
+    return;
+  }
+  if (s_app_timer_handle) {
+    app_timer_cancel(s_app_timer_handle);
+    s_app_timer_handle = NULL;
+  }
+  s_armed_time = NOT_ARMED;
+  if (!deadline) {
+    return;
+  }
+  time_t now_seconds = 0;
+  uint16_t now_ms = 0;
+  time_ms(&now_seconds, &now_ms);
+  int delay_ms = (deadline->time - (int) now_seconds) * MS_PER_SECOND - now_ms;
+  s_app_timer_handle = app_timer_register(max(delay_ms, 0), app_timer_handler, NULL);
+  s_armed_time = deadline->time;
+}
+
+static void app_timer_handler(void* data)
+{
+  PROFILE_BEGIN(scheduler_timer);
+  trace_event(TRACE_EVENT_APP_TIMER_FIRED, 0, s_armed_time);
+  energy_count(ENERGY_COUNTER_APP_TIMER);
+  s_app_timer_handle = NULL;
+  s_armed_time = NOT_ARMED;
+  int now = time(NULL);
+  // Only handle the deadlines that are due now, so a zero length timer that
+  // keeps repeating can't starve the event loop
+  int num_deadlines = heap_size(s_deadlines);
+  for (int i = 0; i < num_deadlines; ++i) {
+    struct Deadline* deadline = heap_top(s_deadlines);
+    if (!deadline || deadline->time > now) {
+      break;
+    }
+    heap_pop(s_deadlines);
+    handle_deadline(deadline);
+    deadline_destroy(deadline);
+  }
+  arm_app_timer();
+  PROFILE_END(scheduler_timer);
+}
+
+// Helpers
+static void handle_deadline(const struct Deadline* deadline)
+{
+  struct App_data* app_data = app_data_get();
+  struct Timer* timer = app_data_get_timer_by_id(app_data, deadline->timer_id);
+  if (!timer || !timer_is_running(timer)) {
+    // Stale deadline
+    return;
+  }
+  timer_update(timer);
+  if (!timer_is_elapsed(timer)) {
+    // The timer changed since the deadline was pushed
+    push_deadline(deadline->timer_id, timer_get_end_time(timer), DEADLINE_TYPE_END);
+    return;
+  }
+  struct Timer_group* timer_group = app_data_get_timer_group(app_data,
+    app_data_get_timer_group_index_by_timer_id(app_data, deadline->timer_id));
+  assert(timer_group);
+  struct Run_config config;
+  timer_group_get_run_config(timer_group, &config);
+  int timer_index = timer_group_get_timer_index(timer_group, deadline->timer_id);
+  int end_time = timer_get_end_time(timer);
+  struct Run_state state = deadline->type == DEADLINE_TYPE_NUDGE ?
+    run_state_elapsed(timer_index, end_time, deadline->nudge_index) : run_state_running(timer_index, end_time);
+  struct Run_env env = {
+    .clock = run_clock,
+    .clock_context = NULL,
+    .sink = run_event_handler,
+    .sink_context = (void*) deadline
+  };
+  if (!run_state_handle_deadline(&state, &config, &env)) {
+    return;
+  }
+  if (deadline->type == DEADLINE_TYPE_NUDGE) {
+    // The wakeups of the series stay registered
+    schedule_nudge(timer, timer_group, state.nudge_index, deadline->planned_nudges_end);
+    notify(SCHEDULER_EVENT_NUDGE, deadline->timer_id, deadline->timer_id);
+    return;
+  }
+  notify(SCHEDULER_EVENT_ELAPSED, deadline->timer_id, deadline->timer_id);
+  if (config.progress_style != PROGRESS_STYLE_AUTO) {
+    // The series resumes where it is by now, in case the app was closed while
+    // the timer waited. Nothing is registered yet, so the series is planned.
+    schedule_nudge(timer, timer_group, state.nudge_index, state.nudge_index);
+    return;
+  }
+  wakeup_manager_cancel(app_data_get_wakeup_manager(app_data), timer);
+  if (state.timer_index == timer_index && state.end_time == end_time) {
+    // The group doesn't progress
+    return;
+  }
+  timer_reset(timer);
+  struct Timer* next_timer = timer_group_get_timer(timer_group, state.timer_index);
+  timer_reset(next_timer);
+  // Start from when the previous timer elapsed so the group doesn't drift
+  timer_start_at(next_timer, state.end_time - timer_get_length_seconds(next_timer));
+  if (state.phase == RUN_PHASE_RUNNING) {
+    scheduler_timer_add(next_timer);
+  }
+  // Otherwise the group finished while the app was closed, and this was its alert
+  notify(SCHEDULER_EVENT_PROGRESS, timer_get_id(next_timer), deadline->timer_id);
+}
+
+// The launch wakeup decides whether an elapsed timer that waits for the user
+// still has to alert
+static void wakeup_fired_handler(int timer_id, int wakeup_time, void* context)
+{
+  struct App_data* app_data = app_data_get();
+  struct Timer* timer = app_data_get_timer_by_id(app_data, timer_id);
+  if (!timer || !timer_is_running(timer) || !timer_is_elapsed(timer)) {
+    return;
+  }
+  struct Timer_group* timer_group = app_data_get_timer_group(app_data,
+    app_data_get_timer_group_index_by_timer_id(app_data, timer_id));
+  if (settings_get_progress_style(timer_group_get_settings(timer_group)) == PROGRESS_STYLE_AUTO) {
+    // Its end deadline catches the group up
+    return;
+  }
+  remove_deadlines(timer_id);
+  push_relaunch_deadline(timer, timer_group, wakeup_time);
+}
+
+static int run_clock(void* context)
+{
+  return time(NULL);
+}
+
+// Alerts happen right away. Subscribers hear about progress once the timers
+// reflect it.
+static void run_event_handler(const struct Run_event_data* event_data, void* context)
+{
+  const struct Deadline* deadline = context;
+  // Lateness is measured from the deadline that fired, so a nudge counts from
+  // its own time rather than from when the timer elapsed
+  switch (event_data->event) {
+    case RUN_EVENT_ELAPSED:
+      trace_event(TRACE_EVENT_TIMER_ELAPSED, deadline->timer_id, event_data->due_time);
+      alert(deadline->timer_id, deadline->time);
+      return;
+    case RUN_EVENT_NUDGE:
+      alert(deadline->timer_id, deadline->time);
+      return;
+    case RUN_EVENT_PROGRESS:
+      return;
+    case RUN_EVENT_INVALID: // intentional fall through
+    default:
+      APP_LOG(APP_LOG_LEVEL_ERROR, "Invalid run event: %d", event_data->event);
+      return;
+  }
+}
+
+static void select_event_handler(const struct Run_event_data* event_data, void* context)
+{
+  struct Run_event_data* progress = context;
+  if (event_data->event == RUN_EVENT_PROGRESS) {
+    *progress = *event_data;
+  }
+}
+
+static void alert(int timer_id, int due_time)
+{
+  trace_event(TRACE_EVENT_VIBRATION, timer_id, due_time);
+  alert_latency_record(due_time);
+  struct App_data* app_data = app_data_get();
+  struct Timer_group* timer_group = app_data_get_timer_group(app_data,
+    app_data_get_timer_group_index_by_timer_id(app_data, timer_id));
+  assert(timer_group);
+  energy_count_vibration(timer_group_get_settings(timer_group));
+  vibes_double_pulse();
+}
+
+// Register the upcoming transitions of the timer's group as wakeups, so the
+// group keeps progressing while the app is closed
+static void schedule_wakeups(const struct Timer* timer)
+{
+  struct App_data* app_data = app_data_get();
+  struct Timer_group* timer_group = app_data_get_timer_group(app_data,
+    app_data_get_timer_group_index_by_timer_id(app_data, timer_get_id(timer)));
+  assert(timer_group);
+  struct Planned_transition transitions[SCHEDULE_PLAN_LENGTH];
+  int num_transitions = timer_group_plan(timer_group, timer_group_get_timer_index(timer_group, timer_get_id(timer)),
+    timer_get_end_time(timer), transitions, SCHEDULE_PLAN_LENGTH);
+  int times[SCHEDULE_PLAN_LENGTH];
+  for (int i = 0; i < num_transitions; ++i) {
+    times[i] = transitions[i].time;
+  }
+  wakeup_manager_schedule_times(app_data_get_wakeup_manager(app_data), timer, times, num_transitions);
+}
+
+static void defer_wakeup_sync(int timer_id)
+{
+  work_queue_defer_once(sync_wakeups, (void*) (intptr_t) timer_id);
+}
+
+static void sync_wakeups(void* context)
+{
+  int timer_id = (int) (intptr_t) context;
+  struct Timer* timer = app_data_get_timer_by_id(app_data_get(), timer_id);
+  struct Deadline* deadline = heap_find_arg(s_deadlines, &timer_id, (Heap_compare_arg_fp_t) deadline_compare_timer_id);
+  if (timer && deadline && deadline->type == DEADLINE_TYPE_END) {
+    schedule_wakeups(timer);
+  } else if (!timer || !deadline) {
+    struct Timer_id_set timer_id_set = { &timer_id, 1 };
+    wakeup_manager_cancel_timer_ids(app_data_get_wakeup_manager(app_data_get()), &timer_id_set);
+  }
+  // Otherwise the timer is nudging and its series is registered already
+}
+
+static void cancel_wakeups(void* context)
+{
+  struct Timer_id_set* timer_id_set = context;
+  wakeup_manager_cancel_timer_ids(app_data_get_wakeup_manager(app_data_get()), timer_id_set);
+  timer_id_set_clear(timer_id_set);
+  free(timer_id_set);
+}
+
+static void schedule_nudge(const struct Timer* timer, const struct Timer_group* timer_group,
+  int nudge_index, int planned_nudges_end)
+{
+  struct Wakeup_manager* wakeup_manager = app_data_get_wakeup_manager(app_data_get());
+  enum Vibrate_style vibrate_style = settings_get_vibrate_style(timer_group_get_settings(timer_group));
+  int end_time = timer_get_end_time(timer);
+  int offset = nudge_policy_get_offset(vibrate_style, nudge_index);
+  if (offset < 0) {
+    // The series is over
+    wakeup_manager_cancel(wakeup_manager, timer);
+    return;
+  }
+  if (nudge_index >= planned_nudges_end) {
+    // Register the next part of the series
+    int times[NUDGE_PLAN_LENGTH];
+    int num_times = nudge_policy_plan(vibrate_style, end_time, nudge_index, times, NUDGE_PLAN_LENGTH,
+      &planned_nudges_end);
+    wakeup_manager_schedule_times(wakeup_manager, timer, times, num_times);
+    energy_add_nudge_wakeups(timer_group_get_settings(timer_group), num_times);
+  }
+  struct Deadline* deadline = push_deadline(timer_get_id(timer), end_time + offset, DEADLINE_TYPE_NUDGE);
+  deadline->nudge_index = nudge_index;
+  deadline->planned_nudges_end = planned_nudges_end;
+}
+
+// An auto progress group that ran off its last timer has nothing left to do
+static bool is_finished(const struct Timer_group* timer_group, int timer_index)
+{
+  return settings_get_progress_style(timer_group_get_settings(timer_group)) == PROGRESS_STYLE_AUTO &&
+    timer_group_get_next_timer_index(timer_group, timer_index) < 0;
+}
+
+static void notify(enum Scheduler_event event, int timer_id, int previous_timer_id)
+{
+  struct Scheduler_event_data event_data = {
+    .event = event,
+    .timer_id = timer_id,
+    .previous_timer_id = previous_timer_id
+  };
+  for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+    if (s_subscribers[i].func_ptr) {
+      s_subscribers[i].func_ptr(&event_data, s_subscribers[i].context);
+    }
+  }
+}
@@ -0,0 +1,68 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+/*
+Singleton that owns the running state of every timer in every group. Keeps a
+min-heap of the deadlines of all running timers and a single app timer armed for
+the earliest one. When a deadline passes, the scheduler vibrates, nudges and
+auto-progresses the timer's group whether or not any window shows the timer.
+Windows subscribe to be told when that happens.
+Deadlines change right away; the matching wakeups are scheduled through the
+work queue, so clicks that start or stop timers redraw first.
+*/
+
+struct Timer;
+struct Timer_group;
+
+enum Scheduler_event {
+  SCHEDULER_EVENT_ELAPSED,  // The timer elapsed
+  SCHEDULER_EVENT_NUDGE,    // The elapsed timer is still waiting for the user
+  SCHEDULER_EVENT_PROGRESS, // The group moved from previous_timer_id to timer_id
+  SCHEDULER_EVENT_INVALID
+};
+
+struct Scheduler_event_data {
+  enum Scheduler_event event;
+  int timer_id;
+  int previous_timer_id;
+};
+
+typedef void (*Scheduler_event_fp_t) (const struct Scheduler_event_data* event_data, void* context);
+
+// Build the deadline heap from the running timers in the app data
+void scheduler_init();
+// Should only be called when the app is exiting, before the app data is destroyed
+void scheduler_deinit();
+
+// Return a subscription handle, or negative if there are too many subscribers
+int scheduler_subscribe(Scheduler_event_fp_t func_ptr, void* context);
+void scheduler_unsubscribe(int handle);
+
+// Start/resume the timer and track its deadline
+void scheduler_timer_start(struct Timer* timer);
+// Pause the timer and stop tracking its deadline
+void scheduler_timer_pause(struct Timer* timer);
+// Reset the timer and stop tracking its deadline
+void scheduler_timer_reset(struct Timer* timer);
+// Same as run_state_select for the timer's group: an elapsed timer moves the
+// group on to its next timer, or resets if there is none; a running timer
+// pauses; anything else starts. Subscribers hear about progress. Return the
+// timer that is current afterwards.
+struct Timer* scheduler_timer_select(struct Timer* timer);
+// Track the deadline of a timer that is already running
+void scheduler_timer_add(const struct Timer* timer);
+// Stop tracking the timer's deadline without changing the timer. Should be
+// called before the timer is edited or destroyed.
+void scheduler_timer_remove(const struct Timer* timer);
+// Reset all the group's timers, then start the one at timer_index. Costs one
+// pass over the deadlines and the wakeup table.
+void scheduler_group_start(struct Timer_group* timer_group, int timer_index);
+// Track the deadlines of all the group's running timers, e.g. after the group
+// is restarted. Costs one pass over the deadlines and the wakeup table.
+void scheduler_group_add(const struct Timer_group* timer_group);
+// Stop tracking the deadlines of all the group's timers. Should be called
+// before the group is destroyed. Costs one pass over the deadlines and the
+// wakeup table.
+void scheduler_group_remove(const struct Timer_group* timer_group);
+
+#endif /*SCHEDULER_H*/
@@ -2,13 +2,16 @@
 #include "Utility.h"
 #include "assert.h"
 #include "persist_util.h"
+#include "Model_events.h"
 
 #include <pebble.h>
 
+static int s_generation = 0;
+
 struct Settings {
   enum Repeat_style repeat_style;     /* repeat the group after the last timer completes. */
   enum Progress_style progress_style; /* Automatically start the next timer after the current one completes. */
-  enum Vibrate_style vibrate_style;   /* (Only if wait for user) Continuous or nudge every minute. */
+  enum Vibrate_style vibrate_style;   /* (Only if not auto progress) How the user is nudged, see Nudge_policy. */
 };
 
 struct Settings* settings_create()
@@ -35,13 +38,15 @@ struct Settings* settings_load()
 void settings_save(const struct Settings* settings)
 {
   assert(settings);
-  persist_write_data(g_current_persist_key++, settings, sizeof(struct Settings));
+  persist_util_write_data(g_current_persist_key++, settings, sizeof(struct Settings));
 }
 
 void settings_set_repeat_style(struct Settings* settings, enum Repeat_style repeat_style)
 {
   assert(settings);
+  ++s_generation;
   settings->repeat_style = repeat_style;
+  model_events_notify(MODEL_EVENT_SETTINGS_CHANGED, settings);
 }
 
 enum Repeat_style settings_get_repeat_style(const struct Settings* settings)
@@ -53,7 +58,9 @@ enum Repeat_style settings_get_repeat_style(const struct Settings* settings)
 void settings_set_progress_style(struct Settings* settings, enum Progress_style progress_style)
 {
   assert(settings);
+  ++s_generation;
   settings->progress_style = progress_style;
+  model_events_notify(MODEL_EVENT_SETTINGS_CHANGED, settings);
 }
 
 enum Progress_style settings_get_progress_style(const struct Settings* settings)
@@ -65,7 +72,9 @@ enum Progress_style settings_get_progress_style(const struct Settings* settings)
 void settings_set_vibrate_style(struct Settings* settings, enum Vibrate_style vibrate_style)
 {
   assert(settings);
+  ++s_generation;
   settings->vibrate_style = vibrate_style;
+  model_events_notify(MODEL_EVENT_SETTINGS_CHANGED, settings);
 }
 
 enum Vibrate_style settings_get_vibrate_style(const struct Settings* settings)
@@ -74,6 +83,11 @@ enum Vibrate_style settings_get_vibrate_style(const struct Settings* settings)
   return settings->vibrate_style;
 }
 
+int settings_get_generation()
+{
+  return s_generation;
+}
+
 const char * settings_get_settings_field_text(enum Settings_field settings_field)
 {
   switch (settings_field) {
@@ -128,6 +142,10 @@ const char * settings_get_vibrate_style_text(enum Vibrate_style vibrate_style)
       return "Nudge";
     case VIBRATE_STYLE_CONTINUOUS:
       return "Continuous";
+    case VIBRATE_STYLE_NUDGE_BACKOFF:
+      return "Nudge less often";
+    case VIBRATE_STYLE_NUDGE_LIMITED:
+      return "Nudge 5 times";
     case VIBRATE_STYLE_INVALID: // intentional fall through
     default:
       return "";
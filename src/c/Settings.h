@@ -28,8 +28,10 @@ enum Progress_style {
 
 enum Vibrate_style {
   VIBRATE_STYLE_NONE,
-  VIBRATE_STYLE_NUDGE,
-  VIBRATE_STYLE_CONTINUOUS,
+  VIBRATE_STYLE_NUDGE,          // Nudge every minute
+  VIBRATE_STYLE_CONTINUOUS,     // Nudge every few seconds for a few minutes
+  VIBRATE_STYLE_NUDGE_BACKOFF,  // Nudge less and less often, then stop
+  VIBRATE_STYLE_NUDGE_LIMITED,  // Nudge every minute a few times, then stop
   VIBRATE_STYLE_INVALID
 };
 
@@ -48,6 +50,10 @@ enum Progress_style settings_get_progress_style(const struct Settings* settings)
 void settings_set_vibrate_style(struct Settings* settings, enum Vibrate_style vibrate_style);
 enum Vibrate_style settings_get_vibrate_style(const struct Settings* settings);
 
+// Return a number that changes whenever any settings change. Lets callers
+// cache values derived from settings.
+int settings_get_generation();
+
 const char * settings_get_settings_field_text(enum Settings_field settings_field);
 const char * settings_get_repeat_style_text(enum Repeat_style repeat_style);
 const char * settings_get_progress_style_text(enum Progress_style progress_style);
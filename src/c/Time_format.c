@@ -0,0 +1,112 @@
+#include "Time_format.h"
+
+#define SECONDS_PER_MINUTE 60
+#define SECONDS_PER_HOUR 3600
+
+// Helpers
+// Write value into out with at least min_digits digits and return the number
+// written. Negative values are written as zero.
+static int write_digits(char* out, int value, int min_digits);
+// Copy the length characters of text into buf as far as buf_size allows
+static int finish(char* buf, int buf_size, const char* text, int length);
+
+int time_format_hms(char* buf, int buf_size, int hours, int minutes, int seconds)
+{
+  char text[TIME_FORMAT_MAX_LENGTH];
+  int length = write_digits(text, hours, 1);
+  text[length++] = ':';
+  length += write_digits(text + length, minutes, 2);
+  text[length++] = ':';
+  length += write_digits(text + length, seconds, 2);
+  return finish(buf, buf_size, text, length);
+}
+
+int time_format_ms(char* buf, int buf_size, int minutes, int seconds)
+{
+  char text[TIME_FORMAT_MAX_LENGTH];
+  int length = write_digits(text, minutes, 1);
+  text[length++] = ':';
+  length += write_digits(text + length, seconds, 2);
+  return finish(buf, buf_size, text, length);
+}
+
+int time_format_s(char* buf, int buf_size, int seconds)
+{
+  char text[TIME_FORMAT_MAX_LENGTH];
+  int length = 0;
+  text[length++] = ':';
+  length += write_digits(text + length, seconds, 2);
+  return finish(buf, buf_size, text, length);
+}
+
+int time_format_compact(char* buf, int buf_size, int hours, int minutes, int seconds)
+{
+  if (hours > 0) {
+    return time_format_hms(buf, buf_size, hours, minutes, seconds);
+  } else if (minutes > 0) {
+    return time_format_ms(buf, buf_size, minutes, seconds);
+  } else {
+    return time_format_s(buf, buf_size, seconds);
+  }
+}
+
+int time_format_compact_seconds(char* buf, int buf_size, int duration_seconds)
+{
+  return time_format_compact(buf, buf_size, duration_seconds / SECONDS_PER_HOUR,
+    (duration_seconds % SECONDS_PER_HOUR) / SECONDS_PER_MINUTE, duration_seconds % SECONDS_PER_MINUTE);
+}
+
+int time_format_fixed(char* buf, int buf_size, int hours, int minutes, int seconds)
+{
+  char text[TIME_FORMAT_MAX_LENGTH];
+  int length = write_digits(text, hours, 2);
+  text[length++] = ':';
+  length += write_digits(text + length, minutes, 2);
+  text[length++] = ':';
+  length += write_digits(text + length, seconds, 2);
+  return finish(buf, buf_size, text, length);
+}
+
+int time_format_append(char* buf, int buf_size, const char* text)
+{
+  int length = 0;
+  while (text[length]) {
+    ++length;
+  }
+  return finish(buf, buf_size, text, length);
+}
+
+static int write_digits(char* out, int value, int min_digits)
+{
+  // Enough for any int
+  char digits[10];
+  int num_digits = 0;
+  unsigned int remaining = value > 0 ? value : 0;
+  do {
+    digits[num_digits++] = '0' + remaining % 10;
+    remaining /= 10;
+  } while (remaining > 0);
+  int length = 0;
+  for (; length < min_digits - num_digits; ++length) {
+    out[length] = '0';
+  }
+  while (num_digits > 0) {
+    out[length++] = digits[--num_digits];
+  }
+  return length;
+}
+
+static int finish(char* buf, int buf_size, const char* text, int length)
+{
+  if (buf_size <= 0) {
+    return 0;
+  }
+  if (length > buf_size - 1) {
+    length = buf_size - 1;
+  }
+  for (int i = 0; i < length; ++i) {
+    buf[i] = text[i];
+  }
+  buf[length] = '\0';
+  return length;
+}
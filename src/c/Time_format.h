@@ -0,0 +1,33 @@
+#ifndef TIME_FORMAT_H
+#define TIME_FORMAT_H
+
+/*
+Writes times as digits without going through printf, since they're formatted
+on every countdown tick and menu redraw. Every function writes at most
+buf_size - 1 characters, always null terminates (if buf_size > 0), and returns
+the number of characters it wrote, so results can be concatenated by
+advancing the buffer by the returned length.
+Doesn't depend on the Pebble SDK.
+*/
+
+// Longest text any of the formatters writes, with every field at its widest,
+// not counting the null terminator
+#define TIME_FORMAT_MAX_LENGTH 32
+
+// "1:02:03"
+int time_format_hms(char* buf, int buf_size, int hours, int minutes, int seconds);
+// "2:03". Minutes aren't wrapped at an hour.
+int time_format_ms(char* buf, int buf_size, int minutes, int seconds);
+// ":03"
+int time_format_s(char* buf, int buf_size, int seconds);
+// The shortest of the above that shows every nonzero field: "1:02:03", "2:03" or ":03"
+int time_format_compact(char* buf, int buf_size, int hours, int minutes, int seconds);
+// Same as time_format_compact, for a duration in seconds
+int time_format_compact_seconds(char* buf, int buf_size, int duration_seconds);
+// Every field two digits wide: "01:02:03"
+int time_format_fixed(char* buf, int buf_size, int hours, int minutes, int seconds);
+
+// Copy text like the formatters above; for building strings around their results
+int time_format_append(char* buf, int buf_size, const char* text);
+
+#endif /*TIME_FORMAT_H*/
@@ -2,6 +2,8 @@
 #include "Utility.h"
 #include "assert.h"
 #include "persist_util.h"
+#include "Model_events.h"
+#include "trace.h"
 
 #include <pebble.h>
 #include <stdlib.h>
@@ -13,6 +15,11 @@
 #define MAX_SECONDS 60
 
 static int get_max_value(enum Timer_field timer_field);
+// Set the field without posting a model event. Return zero if the field is invalid.
+static int set_field_intern(struct Timer* timer, const enum Timer_field timer_field, int value);
+
+static int s_length_generation = 0;
+static int s_state_generation = 0;
 
 struct Timer {
   int id;
@@ -29,7 +36,9 @@ struct Timer* timer_create(int timer_id) {
   timer->hours = DEFAULT_VALUE;
   timer->minutes = DEFAULT_VALUE;
   timer->seconds = DEFAULT_VALUE;
-  timer_reset(timer);
+  // Nobody can know about the timer yet, so there is nothing to notify
+  timer->start_time_seconds = DEFAULT_VALUE;
+  timer->elapsed_seconds = DEFAULT_VALUE;
   APP_LOG(APP_LOG_LEVEL_DEBUG, "Timer created with id: %d", timer_id);
   return timer;
 }
@@ -49,7 +58,7 @@ struct Timer* timer_load()
 void timer_save(const struct Timer* timer)
 {
   assert(timer);
-  persist_write_data(g_current_persist_key++, timer, sizeof(struct Timer));
+  persist_util_write_data(g_current_persist_key++, timer, sizeof(struct Timer));
 }
 
 int timer_get_id(const struct Timer* timer)
@@ -61,20 +70,28 @@ int timer_get_id(const struct Timer* timer)
 void timer_set_field(struct Timer* timer, const enum Timer_field timer_field, int value)
 {
   assert(timer);
+  if (set_field_intern(timer, timer_field, value)) {
+    model_events_notify(MODEL_EVENT_TIMER_EDITED, timer);
+  }
+}
+
+static int set_field_intern(struct Timer* timer, const enum Timer_field timer_field, int value)
+{
+  ++s_length_generation;
   switch (timer_field) {
     case TIMER_FIELD_HOURS:
       timer->hours = wrap_value(value, 0, get_max_value(timer_field));
-      return;
+      return 1;
     case TIMER_FIELD_MINUTES:
       timer->minutes = wrap_value(value, 0, get_max_value(timer_field));
-      return;
+      return 1;
     case TIMER_FIELD_SECONDS:
       timer->seconds = wrap_value(value, 0, get_max_value(timer_field));
-      return;
+      return 1;
     case TIMER_FIELD_INVALID: // intentional fall through
     default:
       APP_LOG(APP_LOG_LEVEL_ERROR, "Invalid timer field: %d", timer_field);
-      return;
+      return 0;
   }
 }
 
@@ -133,9 +150,12 @@ void timer_increment_field(struct Timer* timer, const enum Timer_field timer_fie
 
 void timer_set_all(struct Timer* timer, int hours, int minutes, int seconds)
 {
-  timer_set_field(timer, TIMER_FIELD_HOURS, hours);
-  timer_set_field(timer, TIMER_FIELD_MINUTES, minutes);
-  timer_set_field(timer, TIMER_FIELD_SECONDS, seconds);
+  assert(timer);
+  // One event for the whole edit
+  set_field_intern(timer, TIMER_FIELD_HOURS, hours);
+  set_field_intern(timer, TIMER_FIELD_MINUTES, minutes);
+  set_field_intern(timer, TIMER_FIELD_SECONDS, seconds);
+  model_events_notify(MODEL_EVENT_TIMER_EDITED, timer);
 }
 
 int timer_get_length_seconds(const struct Timer* timer)
@@ -144,6 +164,16 @@ int timer_get_length_seconds(const struct Timer* timer)
   return (timer->hours * SECONDS_PER_HOUR) + (timer->minutes * SECONDS_PER_MINUTE) + timer->seconds;
 }
 
+int timer_get_length_generation()
+{
+  return s_length_generation;
+}
+
+int timer_get_state_generation()
+{
+  return s_state_generation;
+}
+
 int timer_get_field_remaining(const struct Timer* timer, const enum Timer_field timer_field)
 {
   assert(timer);
@@ -206,6 +236,15 @@ int timer_is_elapsed(const struct Timer* timer)
   return timer->elapsed_seconds >= timer_get_length_seconds(timer) ? 1 : 0;
 }
 
+int timer_get_end_time(const struct Timer* timer)
+{
+  assert(timer);
+  if (!timer_is_running(timer)) {
+    return 0;
+  }
+  return timer->start_time_seconds + timer_get_length_seconds(timer) - timer->elapsed_seconds;
+}
+
 void timer_start(struct Timer* timer)
 {
   assert(timer);
@@ -213,7 +252,24 @@ void timer_start(struct Timer* timer)
     APP_LOG(APP_LOG_LEVEL_DEBUG, "Timer already started");
     return;
   }
+  ++s_state_generation;
   timer->start_time_seconds = time(NULL);
+  trace_event(TRACE_EVENT_TIMER_START, timer->id, timer_get_end_time(timer));
+  model_events_notify(MODEL_EVENT_TIMER_STATE, timer);
+}
+
+void timer_start_at(struct Timer* timer, int start_time)
+{
+  assert(timer);
+  assert(start_time > 0);
+  if (timer->start_time_seconds > 0) {
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "Timer already started");
+    return;
+  }
+  ++s_state_generation;
+  timer->start_time_seconds = start_time;
+  trace_event(TRACE_EVENT_TIMER_START, timer->id, timer_get_end_time(timer));
+  model_events_notify(MODEL_EVENT_TIMER_STATE, timer);
 }
 
 void timer_pause(struct Timer* timer)
@@ -223,14 +279,19 @@ void timer_pause(struct Timer* timer)
     APP_LOG(APP_LOG_LEVEL_DEBUG, "Timer not started");
     return;
   }
+  ++s_state_generation;
   timer->elapsed_seconds += time(NULL) - timer->start_time_seconds;
   timer->start_time_seconds = DEFAULT_VALUE;
+  trace_event(TRACE_EVENT_TIMER_PAUSE, timer->id, timer_get_length_seconds(timer) - timer->elapsed_seconds);
+  model_events_notify(MODEL_EVENT_TIMER_STATE, timer);
 }
 
 // Reset timer back to its original value
 void timer_reset(struct Timer* timer)
 {
   assert(timer);
+  ++s_state_generation;
   timer->start_time_seconds = DEFAULT_VALUE;
   timer->elapsed_seconds = DEFAULT_VALUE;
+  model_events_notify(MODEL_EVENT_TIMER_STATE, timer);
 }
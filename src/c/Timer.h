@@ -12,7 +12,8 @@ enum Timer_field {
   TIMER_FIELD_INVALID
 };
 
-// Timer id should be retrieved from app_data_get_next_timer_id
+// Timer id should be retrieved from app_data_get_next_timer_id. Posts no model
+// event; adding the timer to a group does.
 struct Timer* timer_create(int timer_id);
 void timer_destroy(struct Timer* timer);
 
@@ -24,9 +25,15 @@ int timer_get_id(const struct Timer* timer);
 void timer_set_field(struct Timer* timer, const enum Timer_field timer_field, int value);
 int timer_get_field(const struct Timer* timer, const enum Timer_field timer_field);
 void timer_increment_field(struct Timer* timer, const enum Timer_field timer_field, int amount);
+// Set all the fields with a single MODEL_EVENT_TIMER_EDITED
 void timer_set_all(struct Timer* timer, int hours, int minutes, int seconds);
 
 int timer_get_length_seconds(const struct Timer* timer);
+// Return a number that changes whenever the length of any timer changes. Lets
+// callers cache values derived from timer lengths.
+int timer_get_length_generation();
+// Return a number that changes whenever any timer is started, paused or reset
+int timer_get_state_generation();
 int timer_get_field_remaining(const struct Timer* timer, const enum Timer_field timer_field);
 int timer_get_remaining_seconds(const struct Timer* timer);
 // Return non-zero if timer is running, zero otherwise
@@ -38,9 +45,15 @@ int timer_is_paused(const struct Timer* timer);
 // Return non-zero if timer is elapsed, zero otherwise
 // Client should call timer_update to get the most accurate result
 int timer_is_elapsed(const struct Timer* timer);
+// Return the time (in seconds since the epoch) at which the running timer
+// elapses. Return zero if the timer isn't running.
+int timer_get_end_time(const struct Timer* timer);
 
 // Start/resume the timer
 void timer_start(struct Timer* timer);
+// Start the timer as if it had been started at the given time (in seconds
+// since the epoch). The timer should be reset first.
+void timer_start_at(struct Timer* timer, int start_time);
 // Pause the timer
 void timer_pause(struct Timer* timer);
 // Reset timer back to its original value
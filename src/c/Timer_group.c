@@ -4,20 +4,56 @@
 #include "Timer.h"
 #include "assert.h"
 #include "Settings.h"
-#include "wakeup_util.h"
+#include "Scheduler.h"
+#include "Schedule_planner.h"
+#include "Run_state.h"
+#include "draw_utility.h"
+#include "Time_format.h"
+#include "Model_events.h"
+#include "globals.h"
 
 #include <pebble.h>
 
+#define SUBTITLE_TEXT_LENGTH 100
+
+// What the cached row text was built from
+struct Row_text_key {
+  int length_generation;
+  int state_generation;
+  int settings_generation;
+  int time; // Only while the group runs; zero otherwise
+};
+
 struct Timer_group {
   struct List* timers;
   struct Settings* settings;
+  // Cached prefix sums of the timer lengths; not saved
+  int* prefix_sums;
+  int prefix_sums_generation;
+  // Cached menu row text; not saved
+  char* title_text;
+  char* subtitle_text;
+  struct Row_text_key row_text_key;
+  char (*timer_texts)[TIMER_TEXT_LENGTH];
+  int timer_texts_generation;
 };
 
+// Helpers
+static void init_cache(struct Timer_group* timer_group);
+static void invalidate_cache(struct Timer_group* timer_group);
+// Return the prefix sums of the timer lengths, updating them if they're stale
+static const int* get_prefix_sums(const struct Timer_group* timer_group);
+static struct Row_text_key get_row_text_key(const struct Timer_group* timer_group);
+// Rebuild the row text if it's stale
+static void update_row_text(const struct Timer_group* timer_group);
+static void get_subtitle_text(char* buf, int buf_size, const struct Timer_group* timer_group);
+
 struct Timer_group* timer_group_create()
 {
   struct Timer_group* timer_group = safe_alloc(sizeof(struct Timer_group));
   timer_group->timers = list_create();
   timer_group->settings = settings_create();
+  init_cache(timer_group);
   return timer_group;
 }
 
@@ -27,6 +63,7 @@ void timer_group_destroy(struct Timer_group* timer_group)
   list_for_each(timer_group->timers, (List_for_each_fp_t)timer_destroy);
   list_destroy(timer_group->timers);
   settings_destroy(timer_group->settings);
+  invalidate_cache(timer_group);
   free(timer_group);
 }
 
@@ -35,6 +72,7 @@ struct Timer_group* timer_group_load()
   struct Timer_group* timer_group = safe_alloc(sizeof(struct Timer_group));
   timer_group->timers = list_load((List_load_item_fp_t) timer_load);
   timer_group->settings = settings_load();
+  init_cache(timer_group);
   return timer_group;
 }
 
@@ -67,6 +105,8 @@ void timer_group_add_timer(struct Timer_group* timer_group, struct Timer* timer)
   assert(timer);
 
   list_add(timer_group->timers, timer);
+  invalidate_cache(timer_group);
+  model_events_notify(MODEL_EVENT_TIMER_ADDED, timer_group);
 }
 
 void timer_group_remove_timer(struct Timer_group* timer_group, int index)
@@ -74,6 +114,8 @@ void timer_group_remove_timer(struct Timer_group* timer_group, int index)
   assert(timer_group);
 
   list_remove(timer_group->timers, index);
+  invalidate_cache(timer_group);
+  model_events_notify(MODEL_EVENT_TIMER_REMOVED, timer_group);
 }
 
 int timer_group_size(const struct Timer_group* timer_group)
@@ -113,8 +155,246 @@ int timer_group_get_timer_index(const struct Timer_group* timer_group, int timer
   return -1;
 }
 
+int timer_group_get_next_timer_index(const struct Timer_group* timer_group, int timer_index)
+{
+  assert(timer_group);
+  return schedule_planner_get_next_index(settings_get_repeat_style(timer_group->settings),
+    settings_get_progress_style(timer_group->settings), timer_group_size(timer_group), timer_index);
+}
+
+int timer_group_get_running_timer_index(const struct Timer_group* timer_group)
+{
+  assert(timer_group);
+  for (int i = 0; i < list_size(timer_group->timers); ++i) {
+    if (timer_is_running(list_get(timer_group->timers, i))) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int timer_group_get_length_seconds(const struct Timer_group* timer_group)
+{
+  assert(timer_group);
+  return get_prefix_sums(timer_group)[timer_group_size(timer_group)];
+}
+
+int timer_group_get_remaining_seconds(const struct Timer_group* timer_group)
+{
+  assert(timer_group);
+  const int* prefix_sums = get_prefix_sums(timer_group);
+  int size = timer_group_size(timer_group);
+  for (int i = 0; i < size; ++i) {
+    struct Timer* timer = list_get(timer_group->timers, i);
+    if (!timer_is_running(timer) && !timer_is_paused(timer)) {
+      continue;
+    }
+    timer_update(timer);
+    if (settings_get_repeat_style(timer_group->settings) == REPEAT_STYLE_SINGLE) {
+      return timer_get_remaining_seconds(timer);
+    }
+    return timer_get_remaining_seconds(timer) + prefix_sums[size] - prefix_sums[i + 1];
+  }
+  return prefix_sums[size];
+}
+
+int timer_group_plan(const struct Timer_group* timer_group, int timer_index, int end_time,
+  struct Planned_transition* transitions, int max_transitions)
+{
+  assert(timer_group);
+  return schedule_planner_plan(get_prefix_sums(timer_group), timer_group_size(timer_group),
+    settings_get_repeat_style(timer_group->settings), settings_get_progress_style(timer_group->settings),
+    timer_index, end_time, transitions, max_transitions);
+}
+
+void timer_group_get_run_config(const struct Timer_group* timer_group, struct Run_config* config)
+{
+  assert(timer_group);
+  assert(config);
+  *config = (struct Run_config) {
+    .prefix_sums = get_prefix_sums(timer_group),
+    .num_timers = timer_group_size(timer_group),
+    .repeat_style = settings_get_repeat_style(timer_group->settings),
+    .progress_style = settings_get_progress_style(timer_group->settings),
+    .vibrate_style = settings_get_vibrate_style(timer_group->settings)
+  };
+}
+
+const char* timer_group_get_title_text(const struct Timer_group* timer_group)
+{
+  assert(timer_group);
+  update_row_text(timer_group);
+  return timer_group->title_text;
+}
+
+const char* timer_group_get_subtitle_text(const struct Timer_group* timer_group)
+{
+  assert(timer_group);
+  update_row_text(timer_group);
+  return timer_group->subtitle_text;
+}
+
+const char* timer_group_get_timer_text(const struct Timer_group* timer_group, int index)
+{
+  assert(timer_group);
+  assert(in_range(index, 0, list_size(timer_group->timers)));
+  // The cache isn't part of the group's logical state
+  struct Timer_group* mutable_timer_group = (struct Timer_group*) timer_group;
+  if (!timer_group->timer_texts || timer_group->timer_texts_generation != timer_get_length_generation()) {
+    if (!timer_group->timer_texts) {
+      mutable_timer_group->timer_texts = safe_alloc(TIMER_TEXT_LENGTH * list_size(timer_group->timers));
+    }
+    for (int i = 0; i < list_size(timer_group->timers); ++i) {
+      struct Timer* timer = list_get(timer_group->timers, i);
+      get_timer_text(mutable_timer_group->timer_texts[i], TIMER_TEXT_LENGTH,
+        timer_get_field(timer, TIMER_FIELD_HOURS),
+        timer_get_field(timer, TIMER_FIELD_MINUTES),
+        timer_get_field(timer, TIMER_FIELD_SECONDS));
+    }
+    mutable_timer_group->timer_texts_generation = timer_get_length_generation();
+  }
+  return timer_group->timer_texts[index];
+}
+
 void timer_group_cancel_wakeups(const struct Timer_group* timer_group)
 {
   assert(timer_group);
-  list_for_each(timer_group->timers, (List_for_each_fp_t)timer_cancel_wakeup);
+  scheduler_group_remove(timer_group);
+}
+
+void timer_group_get_timer_id_set(const struct Timer_group* timer_group, struct Timer_id_set* timer_id_set)
+{
+  assert(timer_group);
+  assert(timer_id_set);
+  int size = list_size(timer_group->timers);
+  timer_id_set->timer_ids = size ? safe_alloc(sizeof(int) * size) : NULL;
+  timer_id_set->size = size;
+  // Insertion sort; groups are small
+  for (int i = 0; i < size; ++i) {
+    int timer_id = timer_get_id(list_get(timer_group->timers, i));
+    int j = i;
+    for (; j > 0 && timer_id_set->timer_ids[j - 1] > timer_id; --j) {
+      timer_id_set->timer_ids[j] = timer_id_set->timer_ids[j - 1];
+    }
+    timer_id_set->timer_ids[j] = timer_id;
+  }
+}
+
+void timer_id_set_clear(struct Timer_id_set* timer_id_set)
+{
+  assert(timer_id_set);
+  free(timer_id_set->timer_ids);
+  timer_id_set->timer_ids = NULL;
+  timer_id_set->size = 0;
+}
+
+int timer_id_set_contains(const struct Timer_id_set* timer_id_set, int timer_id)
+{
+  assert(timer_id_set);
+  int low = 0;
+  int high = timer_id_set->size;
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (timer_id_set->timer_ids[mid] < timer_id) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low < timer_id_set->size && timer_id_set->timer_ids[low] == timer_id;
+}
+
+// Helpers
+static void init_cache(struct Timer_group* timer_group)
+{
+  timer_group->prefix_sums = NULL;
+  timer_group->prefix_sums_generation = 0;
+  timer_group->title_text = NULL;
+  timer_group->subtitle_text = NULL;
+  timer_group->timer_texts = NULL;
+  timer_group->timer_texts_generation = 0;
+}
+
+static void invalidate_cache(struct Timer_group* timer_group)
+{
+  free(timer_group->prefix_sums);
+  timer_group->prefix_sums = NULL;
+  free(timer_group->title_text);
+  timer_group->title_text = NULL;
+  free(timer_group->subtitle_text);
+  timer_group->subtitle_text = NULL;
+  free(timer_group->timer_texts);
+  timer_group->timer_texts = NULL;
+}
+
+static const int* get_prefix_sums(const struct Timer_group* timer_group)
+{
+  // The cache isn't part of the group's logical state
+  struct Timer_group* mutable_timer_group = (struct Timer_group*) timer_group;
+  if (timer_group->prefix_sums && timer_group->prefix_sums_generation == timer_get_length_generation()) {
+    return timer_group->prefix_sums;
+  }
+  int size = list_size(timer_group->timers);
+  if (!timer_group->prefix_sums) {
+    mutable_timer_group->prefix_sums = safe_alloc(sizeof(int) * (size + 1));
+  }
+  mutable_timer_group->prefix_sums[0] = 0;
+  for (int i = 0; i < size; ++i) {
+    mutable_timer_group->prefix_sums[i + 1] = mutable_timer_group->prefix_sums[i] +
+      timer_get_length_seconds(list_get(timer_group->timers, i));
+  }
+  mutable_timer_group->prefix_sums_generation = timer_get_length_generation();
+  return timer_group->prefix_sums;
+}
+
+static struct Row_text_key get_row_text_key(const struct Timer_group* timer_group)
+{
+  bool running = timer_group_get_running_timer_index(timer_group) >= 0;
+  return (struct Row_text_key) {
+    .length_generation = timer_get_length_generation(),
+    .state_generation = timer_get_state_generation(),
+    .settings_generation = settings_get_generation(),
+    .time = running ? time(NULL) : 0
+  };
+}
+
+static void update_row_text(const struct Timer_group* timer_group)
+{
+  struct Row_text_key key = get_row_text_key(timer_group);
+  if (timer_group->title_text && !memcmp(&key, &timer_group->row_text_key, sizeof(key))) {
+    return;
+  }
+  // The cache isn't part of the group's logical state
+  struct Timer_group* mutable_timer_group = (struct Timer_group*) timer_group;
+  if (!timer_group->title_text) {
+    mutable_timer_group->title_text = safe_alloc(MENU_TEXT_LENGTH);
+    mutable_timer_group->subtitle_text = safe_alloc(SUBTITLE_TEXT_LENGTH);
+  }
+  int num_timers = list_size(timer_group->timers);
+  snprintf(mutable_timer_group->title_text, MENU_TEXT_LENGTH, "%d %s", num_timers,
+    num_timers == 1 ? "Timer" : "Timers");
+  mutable_timer_group->subtitle_text[0] = '\0';
+  get_subtitle_text(mutable_timer_group->subtitle_text, SUBTITLE_TEXT_LENGTH, timer_group);
+  mutable_timer_group->row_text_key = key;
+}
+
+static void get_subtitle_text(char* buf, int buf_size, const struct Timer_group* timer_group)
+{
+  assert(buf);
+  int end_index = 0;
+
+  // Group total, or what's left of it while it's running
+  bool running = timer_group_get_running_timer_index(timer_group) >= 0;
+  end_index += time_format_append(buf, buf_size, running ? "Left " : "Total ");
+  end_index += time_format_compact_seconds(buf + end_index, buf_size - end_index, running ?
+    timer_group_get_remaining_seconds(timer_group) : timer_group_get_length_seconds(timer_group));
+  end_index += time_format_append(buf + end_index, buf_size - end_index, "  |  ");
+
+  for (int i = 0; i < timer_group_size(timer_group); ++i) {
+    end_index += time_format_append(buf + end_index, buf_size - end_index,
+      timer_group_get_timer_text(timer_group, i));
+    if (i < timer_group_size(timer_group) - 1) {
+      end_index += time_format_append(buf + end_index, buf_size - end_index, ",  ");
+    }
+  }
 }
@@ -5,6 +5,14 @@ struct Timer_group;
 struct Timer;
 struct List;
 struct Settings;
+struct Planned_transition;
+struct Run_config;
+
+// IDs of a group's timers, kept sorted so membership takes O(log n)
+struct Timer_id_set {
+  int* timer_ids;
+  int size;
+};
 
 struct Timer_group* timer_group_create();
 void timer_group_destroy(struct Timer_group* timer_group);
@@ -26,6 +34,43 @@ struct Timer* timer_group_get_timer_by_id(const struct Timer_group* timer_group,
 // Return the index of the timer with the given ID. Return negative if no timer
 // has the given ID.
 int timer_group_get_timer_index(const struct Timer_group* timer_group, int timer_id);
+// Return the index of the timer that should run after the timer at the given
+// index elapses, according to the group's repeat and progress styles. Return
+// negative if the group shouldn't progress.
+int timer_group_get_next_timer_index(const struct Timer_group* timer_group, int timer_index);
+// Return the total length of the timers in seconds
+int timer_group_get_length_seconds(const struct Timer_group* timer_group);
+// Return the seconds left until the group finishes its current pass through its
+// timers, counting from the running or paused timer. Return the total length if
+// no timer is running or paused.
+int timer_group_get_remaining_seconds(const struct Timer_group* timer_group);
+// Return the index of the first running timer in the group. Return negative if
+// no timer is running.
+int timer_group_get_running_timer_index(const struct Timer_group* timer_group);
+// Fill transitions with up to max_transitions upcoming timer ends, given that
+// the timer at timer_index elapses at end_time. Return the number filled.
+int timer_group_plan(const struct Timer_group* timer_group, int timer_index, int end_time,
+  struct Planned_transition* transitions, int max_transitions);
+// Describe the group to the run state machine. The config is only valid until
+// the group or its timers change.
+void timer_group_get_run_config(const struct Timer_group* timer_group, struct Run_config* config);
+// Menu row text of the group: the number of timers, and its total (or what's
+// left of it while it runs) followed by the length of each timer. Cached until
+// the group, its timers or any settings change, or a second passes while the
+// group runs.
+const char* timer_group_get_title_text(const struct Timer_group* timer_group);
+const char* timer_group_get_subtitle_text(const struct Timer_group* timer_group);
+// Length text of the timer at index, cached until a timer length changes
+const char* timer_group_get_timer_text(const struct Timer_group* timer_group, int index);
+
+// Stop tracking the deadlines of the timers in the group and cancel their wakeups
 void timer_group_cancel_wakeups(const struct Timer_group* timer_group);
 
+// Fill the set with the IDs of the group's timers. Free it with
+// timer_id_set_clear.
+void timer_group_get_timer_id_set(const struct Timer_group* timer_group, struct Timer_id_set* timer_id_set);
+void timer_id_set_clear(struct Timer_id_set* timer_id_set);
+// Return non-zero if the set contains the timer ID
+int timer_id_set_contains(const struct Timer_id_set* timer_id_set, int timer_id);
+
 #endif /*TIMER_GROUP_H*/
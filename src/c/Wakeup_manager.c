@@ -4,23 +4,37 @@
 #include "persist_util.h"
 #include "assert.h"
 #include "Timer.h"
+#include "Timer_group.h"
+#include "Schedule_planner.h"
 #include "App_data.h"
 #include "timer_countdown_window.h"
 #include "globals.h"
+#include "trace.h"
+#include "energy.h"
 
 #include <pebble.h>
 
-// #define INT32_MAX 0x7FFFFFFFFFFFFFFF
+#define INVALID_WAKEUP_ID -1
+#define INVALID_TIMER_ID -1
+// Wakeups can't be scheduled in the past
+#define MIN_WAKEUP_DELAY_SECOND 1
 
 static bool s_wakeup_service_subscribed = false;
 
 struct Wakeup_manager {
-  struct List* wakeup_data_list;
+  struct List* wakeup_data_list; // Sorted by wakeup time
+  WakeupId wakeup_id;            // OS wakeup armed for the earliest entry
+  int wakeup_time;               // Time the OS wakeup is armed for
 };
-static void wakeup_manager_handle_wakeup_intern(struct Wakeup_manager* wakeup_manager, WakeupId wakeup_id, int32_t timer_id);
-// seconds -> number of seconds in the future to set the wakeup
-static void wakeup_manager_schedule_intern(struct Wakeup_manager* wakeup_manager, const struct Timer* timer, int seconds);
-static void wakeup_manager_cancel_intern(struct Wakeup_manager* wakeup_manager, WakeupId wakeup_id, int32_t timer_id);
+// Show the timer the wakeup was for if show_timer is true. func_ptr may be NULL.
+static void wakeup_manager_handle_wakeup_intern(struct Wakeup_manager* wakeup_manager, WakeupId wakeup_id, int32_t cookie,
+  bool show_timer, Wakeup_fired_fp_t func_ptr, void* context);
+// Add an entry without removing the timer's other entries or re-arming
+static void wakeup_manager_insert_intern(struct Wakeup_manager* wakeup_manager, int timer_id, int wakeup_time);
+// Remove all entries for the timer. Return non-zero if any entry was removed.
+static int wakeup_manager_cancel_intern(struct Wakeup_manager* wakeup_manager, int timer_id);
+// Make sure the OS wakeup is armed for the earliest entry
+static void wakeup_manager_arm_intern(struct Wakeup_manager* wakeup_manager);
 
 // Wakeup data
 struct Wakeup_data;
@@ -28,25 +42,32 @@ static struct Wakeup_data* wakeup_data_create();
 static void wakeup_data_destroy(struct Wakeup_data* wakeup_data);
 static struct Wakeup_data* wakeup_data_load();
 static void wakeup_data_save(const struct Wakeup_data* wakeup_data);
-static void wakeup_data_set(struct Wakeup_data* wakeup_data, WakeupId wakeup_id, int timer_id);
-static WakeupId wakeup_data_get_wakeup_id(const struct Wakeup_data* wakeup_data);
+static void wakeup_data_set(struct Wakeup_data* wakeup_data, int timer_id, int wakeup_time);
+static int wakeup_data_get_timer_id(const struct Wakeup_data* wakeup_data);
+static int wakeup_data_get_time(const struct Wakeup_data* wakeup_data);
 static int wakeup_data_compare_timer_id(const int* timer_id, const struct Wakeup_data* wakeup_data);
-static int wakeup_data_compare_wakeup_id(const WakeupId* wakeup_id, const struct Wakeup_data* wakeup_data);
+// Return 0 if the entry belongs to a timer in the set
+static int wakeup_data_compare_timer_id_set(const struct Timer_id_set* timer_id_set,
+  const struct Wakeup_data* wakeup_data);
 
 // Helpers
-static void wakeup_handler(WakeupId wakeup_id, int32_t timer_id);
+static void subscribe_wakeup_service();
+static void wakeup_handler(WakeupId wakeup_id, int32_t cookie);
+static WakeupId schedule_os_wakeup(int wakeup_time, int timer_id);
 static void handle_wakeup_schedule_error(WakeupId error_id);
-static struct Wakeup_data* get_wakeup_data_by_timer_id(const struct Wakeup_manager* wakeup_manager, int timer_id);
-static struct Wakeup_data* get_wakeup_data_by_wakeup_id(const struct Wakeup_manager* wakeup_manager, WakeupId wakeup_id);
+static struct Wakeup_data* get_earliest_wakeup_data(const struct Wakeup_manager* wakeup_manager);
+// Return the ID of the wakeup that launched the app, or INVALID_WAKEUP_ID
+static WakeupId get_launch_wakeup_id();
+// Return non-zero if the timer with the given ID exists and is running
+static int is_timer_running(const struct List* timer_groups, int timer_id);
 
 struct Wakeup_manager* wakeup_manager_create()
 {
   struct Wakeup_manager* wakeup_manager = safe_alloc(sizeof(struct Wakeup_manager));
   wakeup_manager->wakeup_data_list = list_create();
-  if (!s_wakeup_service_subscribed) {
-    wakeup_service_subscribe(wakeup_handler);
-    s_wakeup_service_subscribed = true;
-  }
+  wakeup_manager->wakeup_id = INVALID_WAKEUP_ID;
+  wakeup_manager->wakeup_time = 0;
+  subscribe_wakeup_service();
   return wakeup_manager;
 }
 
@@ -61,60 +82,151 @@ void wakeup_manager_destroy(struct Wakeup_manager* wakeup_manager)
 struct Wakeup_manager* wakeup_manager_load()
 {
   struct Wakeup_manager* wakeup_manager = safe_alloc(sizeof(struct Wakeup_manager));
+  wakeup_manager->wakeup_id = persist_read_int(g_current_persist_key++);
+  wakeup_manager->wakeup_time = persist_read_int(g_current_persist_key++);
   wakeup_manager->wakeup_data_list = list_load((List_load_item_fp_t) wakeup_data_load);
-  if (!s_wakeup_service_subscribed) {
-    wakeup_service_subscribe(wakeup_handler);
-    s_wakeup_service_subscribed = true;
-  }
+  subscribe_wakeup_service();
   return wakeup_manager;
 }
 
 void wakeup_manager_save(const struct Wakeup_manager* wakeup_manager)
 {
   assert(wakeup_manager);
+  persist_util_write_int(g_current_persist_key++, wakeup_manager->wakeup_id);
+  persist_util_write_int(g_current_persist_key++, wakeup_manager->wakeup_time);
   list_save(wakeup_manager->wakeup_data_list, (List_for_each_fp_t) wakeup_data_save);
 }
 
-void wakeup_manager_handle_wakeup(struct Wakeup_manager* wakeup_manager)
+void wakeup_manager_reconcile(struct Wakeup_manager* wakeup_manager, const struct List* timer_groups)
+{
+  assert(wakeup_manager);
+  // The entries the launch wakeup fired for are due, and its ID can't be
+  // queried anymore. Both are left for wakeup_manager_handle_wakeup.
+  int launched = wakeup_manager->wakeup_id != INVALID_WAKEUP_ID &&
+    wakeup_manager->wakeup_id == get_launch_wakeup_id();
+  int now = time(NULL);
+  int num_past_due = 0;
+  int num_orphaned = 0;
+  for (int i = 0; i < list_size(wakeup_manager->wakeup_data_list);) {
+    struct Wakeup_data* wakeup_data = list_get(wakeup_manager->wakeup_data_list, i);
+    if (!launched && wakeup_data_get_time(wakeup_data) <= now) {
+      ++num_past_due;
+    } else if (!is_timer_running(timer_groups, wakeup_data_get_timer_id(wakeup_data))) {
+      ++num_orphaned;
+    } else {
+      ++i;
+      continue;
+    }
+    list_remove(wakeup_manager->wakeup_data_list, i);
+    wakeup_data_destroy(wakeup_data);
+  }
+  // The OS wakeup may have fired or been removed while the app wasn't running
+  int num_lost = 0;
+  time_t wakeup_time = 0;
+  if (!launched && wakeup_manager->wakeup_id != INVALID_WAKEUP_ID &&
+      (!wakeup_query(wakeup_manager->wakeup_id, &wakeup_time) || wakeup_time != wakeup_manager->wakeup_time)) {
+    trace_event(TRACE_EVENT_WAKEUP_CANCELLED, wakeup_manager->wakeup_id, wakeup_manager->wakeup_time);
+    energy_count(ENERGY_COUNTER_WAKEUP_CANCEL);
+    wakeup_cancel(wakeup_manager->wakeup_id);
+    wakeup_manager->wakeup_id = INVALID_WAKEUP_ID;
+    wakeup_manager->wakeup_time = 0;
+    num_lost = 1;
+  }
+  if (!launched) {
+    wakeup_manager_arm_intern(wakeup_manager);
+  }
+  if (num_past_due || num_orphaned || num_lost) {
+    APP_LOG(APP_LOG_LEVEL_INFO, "Wakeups repaired. Past due: %d, orphaned: %d, lost OS wakeup: %d",
+      num_past_due, num_orphaned, num_lost);
+  }
+}
+
+void wakeup_manager_handle_wakeup(struct Wakeup_manager* wakeup_manager, Wakeup_fired_fp_t func_ptr,
+  void* context)
 {
   if (launch_reason() != APP_LAUNCH_WAKEUP) {
     return;
   }
-  WakeupId wakeup_id = 0;
-  int32_t timer_id = 0;
-  wakeup_get_launch_event(&wakeup_id, &timer_id);
-  wakeup_manager_handle_wakeup_intern(wakeup_manager, wakeup_id, timer_id);
+  energy_count(ENERGY_COUNTER_WAKEUP_LAUNCH);
+  WakeupId wakeup_id = INVALID_WAKEUP_ID;
+  int32_t cookie = INVALID_TIMER_ID;
+  wakeup_get_launch_event(&wakeup_id, &cookie);
+  wakeup_manager_handle_wakeup_intern(wakeup_manager, wakeup_id, cookie, true, func_ptr, context);
 }
 
-void wakeup_manager_schedule(struct Wakeup_manager* wakeup_manager, const struct Timer* timer)
+void wakeup_manager_schedule_times(struct Wakeup_manager* wakeup_manager, const struct Timer* timer,
+  const int* times, int num_times)
 {
+  assert(wakeup_manager);
   assert(timer);
-  wakeup_manager_schedule_intern(wakeup_manager, timer, timer_get_remaining_seconds(timer));
+  assert(times);
+  wakeup_manager_cancel_intern(wakeup_manager, timer_get_id(timer));
+  for (int i = 0; i < num_times; ++i) {
+    wakeup_manager_insert_intern(wakeup_manager, timer_get_id(timer), times[i]);
+  }
+  wakeup_manager_arm_intern(wakeup_manager);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "%d wakeups scheduled. Timer id: %d", num_times, timer_get_id(timer));
 }
 
-void wakeup_manager_schedule_nudge(struct Wakeup_manager* wakeup_manager, const struct Timer* timer)
+void wakeup_manager_schedule_group(struct Wakeup_manager* wakeup_manager, const struct Timer_group* timer_group)
 {
-  wakeup_manager_schedule_intern(wakeup_manager, timer, NUDGE_INTERVAL_SECOND);
+  assert(wakeup_manager);
+  assert(timer_group);
+  struct Timer_id_set timer_id_set;
+  timer_group_get_timer_id_set(timer_group, &timer_id_set);
+  // Leave out the elapsed timers, whose entries are the nudges of their series
+  int size = 0;
+  for (int i = 0; i < timer_id_set.size; ++i) {
+    struct Timer* timer = timer_group_get_timer_by_id(timer_group, timer_id_set.timer_ids[i]);
+    if (!timer_is_running(timer) || !timer_is_elapsed(timer)) {
+      timer_id_set.timer_ids[size++] = timer_id_set.timer_ids[i];
+    }
+  }
+  timer_id_set.size = size;
+  list_remove_all_arg(wakeup_manager->wakeup_data_list, &timer_id_set,
+    (List_compare_arg_fp_t) wakeup_data_compare_timer_id_set, (List_for_each_fp_t) wakeup_data_destroy);
+  timer_id_set_clear(&timer_id_set);
+  int num_wakeups = 0;
+  for (int i = 0; i < timer_group_size(timer_group); ++i) {
+    struct Timer* timer = timer_group_get_timer(timer_group, i);
+    if (!timer_is_running(timer) || timer_is_elapsed(timer)) {
+      continue;
+    }
+    struct Planned_transition transitions[SCHEDULE_PLAN_LENGTH];
+    int num_transitions = timer_group_plan(timer_group, i, timer_get_end_time(timer), transitions,
+      SCHEDULE_PLAN_LENGTH);
+    for (int j = 0; j < num_transitions; ++j) {
+      wakeup_manager_insert_intern(wakeup_manager, timer_get_id(timer), transitions[j].time);
+    }
+    num_wakeups += num_transitions;
+  }
+  wakeup_manager_arm_intern(wakeup_manager);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "%d group wakeups scheduled", num_wakeups);
 }
 
-static void wakeup_manager_schedule_intern(struct Wakeup_manager* wakeup_manager, const struct Timer* timer, int seconds)
+void wakeup_manager_cancel_timer_ids(struct Wakeup_manager* wakeup_manager, const struct Timer_id_set* timer_id_set)
 {
   assert(wakeup_manager);
-  assert(timer);
-  struct Wakeup_data* wakeup_data = get_wakeup_data_by_timer_id(wakeup_manager, timer_get_id(timer));
-  if (wakeup_data) {
-    APP_LOG(APP_LOG_LEVEL_WARNING, "Wakeup already scheduled for timer. Timer id: %d", timer_get_id(timer));
-    return;
+  assert(timer_id_set);
+  int removed = list_remove_all_arg(wakeup_manager->wakeup_data_list, timer_id_set,
+    (List_compare_arg_fp_t) wakeup_data_compare_timer_id_set, (List_for_each_fp_t) wakeup_data_destroy);
+  if (removed) {
+    wakeup_manager_arm_intern(wakeup_manager);
   }
-  WakeupId wakeup_id = wakeup_schedule(time(NULL) + seconds, timer_get_id(timer), false);
-  if (wakeup_id < 0) {
-    handle_wakeup_schedule_error(wakeup_id);
-    return;
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "%d wakeups canceled", removed);
+}
+
+static void wakeup_manager_insert_intern(struct Wakeup_manager* wakeup_manager, int timer_id, int wakeup_time)
+{
+  struct Wakeup_data* wakeup_data = wakeup_data_create();
+  wakeup_data_set(wakeup_data, timer_id, wakeup_time);
+  // Keep the list sorted by time; entries with equal times keep their order
+  int index = list_size(wakeup_manager->wakeup_data_list);
+  while (index > 0 &&
+      wakeup_data_get_time(list_get(wakeup_manager->wakeup_data_list, index - 1)) > wakeup_time) {
+    --index;
   }
-  wakeup_data = wakeup_data_create();
-  wakeup_data_set(wakeup_data, wakeup_id, timer_get_id(timer));
-  list_add(wakeup_manager->wakeup_data_list, wakeup_data);
-  APP_LOG(APP_LOG_LEVEL_DEBUG, "Wakeup scheduled. Timer id: %d", timer_get_id(timer));
+  list_insert(wakeup_manager->wakeup_data_list, index, wakeup_data);
 }
 
 void wakeup_manager_cancel(struct Wakeup_manager* wakeup_manager, const struct Timer* timer)
@@ -122,53 +234,154 @@ void wakeup_manager_cancel(struct Wakeup_manager* wakeup_manager, const struct T
   assert(wakeup_manager);
   assert(timer);
   int timer_id = timer_get_id(timer);
-  struct Wakeup_data* wakeup_data = get_wakeup_data_by_timer_id(wakeup_manager, timer_id);
-  if (!wakeup_data) {
-    APP_LOG(APP_LOG_LEVEL_WARNING, "Wakeup not scheduled. Timer id: %d", (int) timer_id);
+  if (!wakeup_manager_cancel_intern(wakeup_manager, timer_id)) {
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "Wakeup not scheduled. Timer id: %d", timer_id);
     return;
   }
-  wakeup_manager_cancel_intern(wakeup_manager, wakeup_data_get_wakeup_id(wakeup_data), timer_id);
+  wakeup_manager_arm_intern(wakeup_manager);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Wakeup canceled. Timer id: %d", timer_id);
 }
 
-static void wakeup_manager_cancel_intern(struct Wakeup_manager* wakeup_manager, WakeupId wakeup_id, int32_t timer_id)
+static int wakeup_manager_cancel_intern(struct Wakeup_manager* wakeup_manager, int timer_id)
 {
-  struct Wakeup_data* wakeup_data = get_wakeup_data_by_wakeup_id(wakeup_manager, wakeup_id);
+  return list_remove_all_arg(wakeup_manager->wakeup_data_list, &timer_id,
+    (List_compare_arg_fp_t) wakeup_data_compare_timer_id, (List_for_each_fp_t) wakeup_data_destroy);
+}
+
+static void wakeup_manager_arm_intern(struct Wakeup_manager* wakeup_manager)
+{
+  struct Wakeup_data* wakeup_data = get_earliest_wakeup_data(wakeup_manager);
+  if (wakeup_data && wakeup_manager->wakeup_id != INVALID_WAKEUP_ID &&
+      wakeup_manager->wakeup_time == wakeup_data_get_time(wakeup_data)) {
+    // Already armed for the earliest entry
+    return;
+  }
+  if (wakeup_manager->wakeup_id != INVALID_WAKEUP_ID) {
+    trace_event(TRACE_EVENT_WAKEUP_CANCELLED, wakeup_manager->wakeup_id, wakeup_manager->wakeup_time);
+    energy_count(ENERGY_COUNTER_WAKEUP_CANCEL);
+    wakeup_cancel(wakeup_manager->wakeup_id);
+    wakeup_manager->wakeup_id = INVALID_WAKEUP_ID;
+    wakeup_manager->wakeup_time = 0;
+  }
   if (!wakeup_data) {
-    APP_LOG(APP_LOG_LEVEL_WARNING, "Wakeup not scheduled. Timer id: %d", (int) timer_id);
     return;
   }
-  wakeup_cancel(wakeup_id);
-  list_remove_ptr(wakeup_manager->wakeup_data_list, wakeup_data);
-  wakeup_data_destroy(wakeup_data);
-  APP_LOG(APP_LOG_LEVEL_DEBUG, "Wakeup canceled. Timer id: %d", (int) timer_id);
+  WakeupId wakeup_id = schedule_os_wakeup(wakeup_data_get_time(wakeup_data),
+    wakeup_data_get_timer_id(wakeup_data));
+  if (wakeup_id < 0) {
+    return;
+  }
+  wakeup_manager->wakeup_id = wakeup_id;
+  wakeup_manager->wakeup_time = wakeup_data_get_time(wakeup_data);
 }
 
-static void wakeup_manager_handle_wakeup_intern(struct Wakeup_manager* wakeup_manager, WakeupId wakeup_id, int32_t timer_id)
+static void wakeup_manager_handle_wakeup_intern(struct Wakeup_manager* wakeup_manager, WakeupId wakeup_id, int32_t cookie,
+  bool show_timer, Wakeup_fired_fp_t func_ptr, void* context)
 {
-  wakeup_manager_cancel_intern(wakeup_manager, wakeup_id, timer_id);
-  timer_countdown_window_push_id(timer_id);
+  assert(wakeup_manager);
+  trace_event(TRACE_EVENT_WAKEUP_FIRED, cookie,
+    wakeup_id == wakeup_manager->wakeup_id ? wakeup_manager->wakeup_time : 0);
+  if (wakeup_id == wakeup_manager->wakeup_id) {
+    // The OS wakeup is gone once it fires
+    wakeup_manager->wakeup_id = INVALID_WAKEUP_ID;
+    wakeup_manager->wakeup_time = 0;
+  }
+  // Drop every entry that is due. The scheduler alerts for the timers
+  // themselves; show the first one that still exists. The scheduler may
+  // already have caught the timer's group up and replaced its entries, so fall
+  // back to the timer the OS wakeup was armed for.
+  int now = time(NULL);
+  int timer_id = INVALID_TIMER_ID;
+  struct Wakeup_data* wakeup_data;
+  while ((wakeup_data = get_earliest_wakeup_data(wakeup_manager)) &&
+      wakeup_data_get_time(wakeup_data) <= now) {
+    if (timer_id == INVALID_TIMER_ID &&
+        app_data_get_timer_by_id(app_data_get(), wakeup_data_get_timer_id(wakeup_data))) {
+      timer_id = wakeup_data_get_timer_id(wakeup_data);
+    }
+    if (func_ptr) {
+      func_ptr(wakeup_data_get_timer_id(wakeup_data), wakeup_data_get_time(wakeup_data), context);
+    }
+    list_remove(wakeup_manager->wakeup_data_list, 0);
+    wakeup_data_destroy(wakeup_data);
+  }
+  wakeup_manager_arm_intern(wakeup_manager);
+  if (timer_id == INVALID_TIMER_ID && cookie >= 0 && app_data_get_timer_by_id(app_data_get(), cookie)) {
+    timer_id = cookie;
+  }
+  if (show_timer && timer_id != INVALID_TIMER_ID) {
+    timer_countdown_window_push_id(timer_id);
+  }
 }
 
 // Helpers
-static void wakeup_handler(WakeupId wakeup_id, int32_t timer_id)
+static void subscribe_wakeup_service()
 {
+  if (!s_wakeup_service_subscribed) {
+    wakeup_service_subscribe(wakeup_handler);
+    s_wakeup_service_subscribed = true;
+  }
+}
+
+static void wakeup_handler(WakeupId wakeup_id, int32_t cookie)
+{
+  // The app is already open and the scheduler alerts on its own, e.g. for
+  // nudges whose wakeups stay registered
   struct Wakeup_manager* wakeup_manager = app_data_get_wakeup_manager(app_data_get());
-  wakeup_manager_handle_wakeup_intern(wakeup_manager, wakeup_id, timer_id);
+  wakeup_manager_handle_wakeup_intern(wakeup_manager, wakeup_id, cookie, false, NULL, NULL);
 }
 
+static WakeupId schedule_os_wakeup(int wakeup_time, int timer_id)
+{
+  wakeup_time = max(wakeup_time, time(NULL) + MIN_WAKEUP_DELAY_SECOND);
+  energy_count(ENERGY_COUNTER_WAKEUP_SCHEDULE);
+  WakeupId wakeup_id = wakeup_schedule(wakeup_time, timer_id, false);
+  if (wakeup_id == E_RANGE || wakeup_id == E_OUT_OF_RESOURCES) {
+    // Every wakeup of this app belongs to this table, so anything else that is
+    // pending is left over and only gets in the way
+    APP_LOG(APP_LOG_LEVEL_WARNING, "Clearing stale wakeups");
+    trace_event(TRACE_EVENT_WAKEUP_CANCELLED, INVALID_WAKEUP_ID, 0);
+    energy_count(ENERGY_COUNTER_WAKEUP_CANCEL);
+    wakeup_cancel_all();
+    energy_count(ENERGY_COUNTER_WAKEUP_SCHEDULE);
+    wakeup_id = wakeup_schedule(wakeup_time, timer_id, false);
+  }
+  if (wakeup_id < 0) {
+    handle_wakeup_schedule_error(wakeup_id);
+  } else {
+    trace_event(TRACE_EVENT_WAKEUP_SCHEDULED, timer_id, wakeup_time);
+  }
+  return wakeup_id;
+}
 
-static struct Wakeup_data* get_wakeup_data_by_timer_id(const struct Wakeup_manager* wakeup_manager, int timer_id)
+static struct Wakeup_data* get_earliest_wakeup_data(const struct Wakeup_manager* wakeup_manager)
 {
   assert(wakeup_manager);
-  return list_find(wakeup_manager->wakeup_data_list, &timer_id,
-    (List_compare_arg_fp_t) wakeup_data_compare_timer_id);
+  if (list_empty(wakeup_manager->wakeup_data_list)) {
+    return NULL;
+  }
+  return list_get(wakeup_manager->wakeup_data_list, 0);
 }
 
-static struct Wakeup_data* get_wakeup_data_by_wakeup_id(const struct Wakeup_manager* wakeup_manager, WakeupId wakeup_id)
+static WakeupId get_launch_wakeup_id()
 {
-  assert(wakeup_manager);
-  return list_find(wakeup_manager->wakeup_data_list, &wakeup_id,
-    (List_compare_arg_fp_t) wakeup_data_compare_wakeup_id);
+  WakeupId wakeup_id = INVALID_WAKEUP_ID;
+  int32_t cookie = 0;
+  if (launch_reason() != APP_LAUNCH_WAKEUP || !wakeup_get_launch_event(&wakeup_id, &cookie)) {
+    return INVALID_WAKEUP_ID;
+  }
+  return wakeup_id;
+}
+
+static int is_timer_running(const struct List* timer_groups, int timer_id)
+{
+  for (int i = 0; i < list_size(timer_groups); ++i) {
+    struct Timer* timer = timer_group_get_timer_by_id(list_get(timer_groups, i), timer_id);
+    if (timer) {
+      return timer_is_running(timer);
+    }
+  }
+  return 0;
 }
 
 static void handle_wakeup_schedule_error(WakeupId error_id)
@@ -193,18 +406,15 @@ static void handle_wakeup_schedule_error(WakeupId error_id)
 
 // Wakeup_data
 struct Wakeup_data {
-  WakeupId wakeup_id;
   int timer_id;
+  int time; // Seconds since the epoch
 };
 
-#define INVALID_WAKEUP_ID -1
-#define INVALID_TIMER_ID -1
-
 static struct Wakeup_data* wakeup_data_create()
 {
   struct Wakeup_data* wakeup_data = safe_alloc(sizeof(struct Wakeup_data));
-  wakeup_data->wakeup_id = INVALID_WAKEUP_ID;
   wakeup_data->timer_id = INVALID_TIMER_ID;
+  wakeup_data->time = 0;
   return wakeup_data;
 }
 
@@ -223,21 +433,27 @@ static struct Wakeup_data* wakeup_data_load()
 static void wakeup_data_save(const struct Wakeup_data* wakeup_data)
 {
   assert(wakeup_data);
-  persist_write_data(g_current_persist_key++, wakeup_data, sizeof(struct Wakeup_data));
+  persist_util_write_data(g_current_persist_key++, wakeup_data, sizeof(struct Wakeup_data));
 }
 
-static void wakeup_data_set(struct Wakeup_data* wakeup_data, WakeupId wakeup_id, int timer_id)
+static void wakeup_data_set(struct Wakeup_data* wakeup_data, int timer_id, int wakeup_time)
 {
   assert(wakeup_data);
   assert(timer_id <= INT32_MAX);
-  wakeup_data->wakeup_id = wakeup_id;
   wakeup_data->timer_id = timer_id;
+  wakeup_data->time = wakeup_time;
+}
+
+static int wakeup_data_get_timer_id(const struct Wakeup_data* wakeup_data)
+{
+  assert(wakeup_data);
+  return wakeup_data->timer_id;
 }
 
-static WakeupId wakeup_data_get_wakeup_id(const struct Wakeup_data* wakeup_data)
+static int wakeup_data_get_time(const struct Wakeup_data* wakeup_data)
 {
   assert(wakeup_data);
-  return wakeup_data->wakeup_id;
+  return wakeup_data->time;
 }
 
 static int wakeup_data_compare_timer_id(const int* timer_id, const struct Wakeup_data* wakeup_data)
@@ -247,9 +463,10 @@ static int wakeup_data_compare_timer_id(const int* timer_id, const struct Wakeup
   return *timer_id - wakeup_data->timer_id;
 }
 
-static int wakeup_data_compare_wakeup_id(const WakeupId* wakeup_id, const struct Wakeup_data* wakeup_data)
+static int wakeup_data_compare_timer_id_set(const struct Timer_id_set* timer_id_set,
+  const struct Wakeup_data* wakeup_data)
 {
-  assert(wakeup_id);
+  assert(timer_id_set);
   assert(wakeup_data);
-  return *wakeup_id - wakeup_data->wakeup_id;
+  return timer_id_set_contains(timer_id_set, wakeup_data->timer_id) ? 0 : 1;
 }
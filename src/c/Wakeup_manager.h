@@ -1,8 +1,22 @@
 #ifndef WAKEUP_MANAGER_H
 #define WAKEUP_MANAGER_H
 
+/*
+Multiplexes the wakeups of all running timers onto a single OS wakeup. Pending
+wakeup times are kept in a table sorted by time that is saved with the app
+data. Only the earliest entry holds an OS wakeup, so the number of running
+timers isn't limited by the number of wakeups an app may schedule, and timers
+that end close together don't collide.
+*/
+
 struct Wakeup_manager;
 struct Timer;
+struct Timer_group;
+struct Timer_id_set;
+struct List;
+
+// Called with each entry the wakeup that launched the app was due for
+typedef void (*Wakeup_fired_fp_t) (int timer_id, int wakeup_time, void* context);
 
 struct Wakeup_manager* wakeup_manager_create();
 void wakeup_manager_destroy(struct Wakeup_manager* wakeup_manager);
@@ -10,10 +24,34 @@ void wakeup_manager_destroy(struct Wakeup_manager* wakeup_manager);
 struct Wakeup_manager* wakeup_manager_load();
 void wakeup_manager_save(const struct Wakeup_manager* wakeup_manager);
 
-void wakeup_manager_handle_wakeup(struct Wakeup_manager* wakeup_manager);
+// Repair the loaded table against the timers and the OS wakeup in one pass.
+// Entries that are past due (their wakeup fired while the app wasn't running)
+// or whose timer no longer exists or isn't running are dropped, and the OS
+// wakeup is re-armed if it's gone. If the armed OS wakeup launched the app,
+// its due entries and ID are left for wakeup_manager_handle_wakeup. Should be
+// called once the timer groups are loaded.
+void wakeup_manager_reconcile(struct Wakeup_manager* wakeup_manager, const struct List* timer_groups);
+
+// Replace the entries of all the group's timers with the upcoming transitions
+// of its running timers, in one pass over the table and re-arming once.
+// Elapsed timers keep their entries.
+void wakeup_manager_schedule_group(struct Wakeup_manager* wakeup_manager, const struct Timer_group* timer_group);
+// Remove the entries of all the timers in the set in one pass over the table.
+// The timers don't need to exist anymore.
+void wakeup_manager_cancel_timer_ids(struct Wakeup_manager* wakeup_manager, const struct Timer_id_set* timer_id_set);
+
+// Drop every entry that is due, calling func_ptr (if not NULL) with each, and
+// re-arm the OS wakeup for the next one, if the app was launched by a wakeup.
+// func_ptr must not change the table. Should be called before anything else
+// changes the table, so the wakeup that fired is still the armed one.
+void wakeup_manager_handle_wakeup(struct Wakeup_manager* wakeup_manager, Wakeup_fired_fp_t func_ptr,
+  void* context);
 
-void wakeup_manager_schedule(struct Wakeup_manager* wakeup_manager, const struct Timer* timer);
-void wakeup_manager_schedule_nudge(struct Wakeup_manager* wakeup_manager, const struct Timer* timer);
+// Replace the timer's entries with one entry for each of the given times
+// (in seconds since the epoch), e.g. the upcoming transitions of its group
+void wakeup_manager_schedule_times(struct Wakeup_manager* wakeup_manager, const struct Timer* timer,
+  const int* times, int num_times);
+// Remove the timer's entries
 void wakeup_manager_cancel(struct Wakeup_manager* wakeup_manager, const struct Timer* timer);
 
 #endif /*WAKEUP_MANAGER_H*/
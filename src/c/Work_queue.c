@@ -0,0 +1,69 @@
+#include "Work_queue.h"
+#include "energy.h"
+
+#include <pebble.h>
+
+#define WORK_QUEUE_SIZE 16
+
+struct Work_item {
+  Work_queue_fp_t func_ptr;
+  void* context;
+};
+
+// Ring buffer
+static struct Work_item s_work_items[WORK_QUEUE_SIZE];
+static int s_first_index = 0;
+static int s_num_work_items = 0;
+static AppTimer* s_app_timer_handle = NULL;
+
+// Helpers
+static void app_timer_handler(void* data);
+
+void work_queue_defer(Work_queue_fp_t func_ptr, void* context)
+{
+  if (s_num_work_items >= WORK_QUEUE_SIZE) {
+    // Keep the order rather than drop work
+    work_queue_flush();
+  }
+  struct Work_item* work_item = &s_work_items[(s_first_index + s_num_work_items) % WORK_QUEUE_SIZE];
+  work_item->func_ptr = func_ptr;
+  work_item->context = context;
+  ++s_num_work_items;
+  if (!s_app_timer_handle) {
+    s_app_timer_handle = app_timer_register(0, app_timer_handler, NULL);
+  }
+}
+
+void work_queue_defer_once(Work_queue_fp_t func_ptr, void* context)
+{
+  for (int i = 0; i < s_num_work_items; ++i) {
+    struct Work_item* work_item = &s_work_items[(s_first_index + i) % WORK_QUEUE_SIZE];
+    if (work_item->func_ptr == func_ptr && work_item->context == context) {
+      return;
+    }
+  }
+  work_queue_defer(func_ptr, context);
+}
+
+void work_queue_flush()
+{
+  if (s_app_timer_handle) {
+    app_timer_cancel(s_app_timer_handle);
+    s_app_timer_handle = NULL;
+  }
+  // Work may defer more work; it runs in this pass too
+  while (s_num_work_items > 0) {
+    struct Work_item work_item = s_work_items[s_first_index];
+    s_first_index = (s_first_index + 1) % WORK_QUEUE_SIZE;
+    --s_num_work_items;
+    work_item.func_ptr(work_item.context);
+  }
+}
+
+// Helpers
+static void app_timer_handler(void* data)
+{
+  energy_count(ENERGY_COUNTER_APP_TIMER);
+  s_app_timer_handle = NULL;
+  work_queue_flush();
+}
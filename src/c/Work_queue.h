@@ -0,0 +1,21 @@
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+/*
+Queue of side effects that don't change what is on screen, like scheduling
+wakeups. Click handlers update their layers and defer the rest, so the frame is
+drawn before the slow work runs. The queue is drained from a zero delay app
+timer, in the order the work was deferred.
+*/
+
+typedef void (*Work_queue_fp_t)(void* context);
+
+// Run func_ptr with context once the current event has been handled
+void work_queue_defer(Work_queue_fp_t func_ptr, void* context);
+// Like work_queue_defer, unless the same function is already queued with the
+// same context. For work that only brings something up to date.
+void work_queue_defer_once(Work_queue_fp_t func_ptr, void* context);
+// Run all the queued work now. Should be called before the app exits.
+void work_queue_flush();
+
+#endif /*WORK_QUEUE_H*/
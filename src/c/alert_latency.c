@@ -0,0 +1,132 @@
+#include "alert_latency.h"
+#include "Utility.h"
+#include "assert.h"
+#include "globals.h"
+
+#include <pebble.h>
+
+// Bumped when samples saved before no longer mean the same, e.g. the launch
+// replays of elapse alerts, which were due long before
+#define ALERT_LATENCY_VERSION 2
+
+// Saved as is, so changing it resets the saved histogram through the size check
+struct Alert_latency_data {
+  uint32_t version;
+  uint32_t counts[ALERT_NUM_PATHS][ALERT_LATENCY_NUM_BUCKETS];
+  uint32_t max_ms[ALERT_NUM_PATHS];
+};
+
+// Exclusive upper bound of each bucket but the last, in milliseconds
+static const int32_t s_bucket_limits_ms[ALERT_LATENCY_NUM_BUCKETS - 1] = {
+  100, 250, 500, 1000, 2000, 5000, 10000, 30000, 60000, 300000
+};
+
+static const char* const s_bucket_names[ALERT_LATENCY_NUM_BUCKETS] = {
+  "< 100 ms", "< 250 ms", "< 500 ms", "< 1 s", "< 2 s", "< 5 s", "< 10 s", "< 30 s", "< 1 min", "< 5 min",
+  ">= 5 min"
+};
+
+static const char* const s_path_names[ALERT_NUM_PATHS] = {
+  [ALERT_PATH_FOREGROUND] = "Foreground",
+  [ALERT_PATH_WAKEUP_LAUNCH] = "Wakeup launch",
+  [ALERT_PATH_OTHER_LAUNCH] = "Other launch"
+};
+
+static struct Alert_latency_data s_data;
+// Alerts due before this were delivered by the launch
+static int s_launch_time = 0;
+static AppLaunchReason s_launch_reason = APP_LAUNCH_SYSTEM;
+
+// Helpers
+static int get_bucket(int64_t lateness_ms);
+
+void alert_latency_init()
+{
+  s_launch_time = time(NULL);
+  s_launch_reason = launch_reason();
+  if (persist_get_size(ALERT_LATENCY_PERSIST_KEY) != (int) sizeof(s_data) ||
+      persist_read_data(ALERT_LATENCY_PERSIST_KEY, &s_data, sizeof(s_data)) != (int) sizeof(s_data) ||
+      s_data.version != ALERT_LATENCY_VERSION) {
+    alert_latency_reset();
+  }
+}
+
+void alert_latency_deinit()
+{
+  persist_write_data(ALERT_LATENCY_PERSIST_KEY, &s_data, sizeof(s_data));
+}
+
+void alert_latency_record(int due_time)
+{
+  time_t seconds;
+  uint16_t ms;
+  time_ms(&seconds, &ms);
+  int64_t lateness_ms = ((int64_t) seconds - due_time) * MS_PER_SECOND + ms;
+  if (lateness_ms < 0) {
+    // Early alerts count as on time
+    lateness_ms = 0;
+  }
+  enum Alert_path path = ALERT_PATH_FOREGROUND;
+  if (due_time <= s_launch_time) {
+    path = s_launch_reason == APP_LAUNCH_WAKEUP ? ALERT_PATH_WAKEUP_LAUNCH : ALERT_PATH_OTHER_LAUNCH;
+  }
+  ++s_data.counts[path][get_bucket(lateness_ms)];
+  uint32_t clamped_ms = lateness_ms < INT32_MAX ? lateness_ms : INT32_MAX;
+  if (clamped_ms > s_data.max_ms[path]) {
+    s_data.max_ms[path] = clamped_ms;
+  }
+}
+
+void alert_latency_reset()
+{
+  memset(&s_data, 0, sizeof(s_data));
+  s_data.version = ALERT_LATENCY_VERSION;
+}
+
+int alert_latency_get_count(enum Alert_path path, int bucket)
+{
+  assert(in_range(path, 0, ALERT_NUM_PATHS));
+  assert(in_range(bucket, 0, ALERT_LATENCY_NUM_BUCKETS));
+  return s_data.counts[path][bucket];
+}
+
+int alert_latency_get_max_ms(enum Alert_path path)
+{
+  assert(in_range(path, 0, ALERT_NUM_PATHS));
+  return s_data.max_ms[path];
+}
+
+const char* alert_latency_get_path_name(enum Alert_path path)
+{
+  assert(in_range(path, 0, ALERT_NUM_PATHS));
+  return s_path_names[path];
+}
+
+const char* alert_latency_get_bucket_name(int bucket)
+{
+  assert(in_range(bucket, 0, ALERT_LATENCY_NUM_BUCKETS));
+  return s_bucket_names[bucket];
+}
+
+void alert_latency_log()
+{
+  for (int path = 0; path < ALERT_NUM_PATHS; ++path) {
+    APP_LOG(APP_LOG_LEVEL_INFO, "Alert latency, %s: max %d ms", s_path_names[path], (int) s_data.max_ms[path]);
+    for (int bucket = 0; bucket < ALERT_LATENCY_NUM_BUCKETS; ++bucket) {
+      if (s_data.counts[path][bucket] > 0) {
+        APP_LOG(APP_LOG_LEVEL_INFO, "  %s: %d", s_bucket_names[bucket], (int) s_data.counts[path][bucket]);
+      }
+    }
+  }
+}
+
+// Helpers
+static int get_bucket(int64_t lateness_ms)
+{
+  for (int bucket = 0; bucket < ALERT_LATENCY_NUM_BUCKETS - 1; ++bucket) {
+    if (lateness_ms < s_bucket_limits_ms[bucket]) {
+      return bucket;
+    }
+  }
+  return ALERT_LATENCY_NUM_BUCKETS - 1;
+}
@@ -0,0 +1,43 @@
+#ifndef ALERT_LATENCY_H
+#define ALERT_LATENCY_H
+
+/*
+Histogram of how late alerts vibrate compared to when they were due. Alerts
+are split by how they were delivered: by the running app, or by a launch that
+happened because the alert was due, through a wakeup or otherwise. The
+histogram is persisted, so it accumulates across launches until it's reset.
+*/
+
+// Persist key of the histogram, above the trace keys
+#define ALERT_LATENCY_PERSIST_KEY 300000
+
+enum Alert_path {
+  ALERT_PATH_FOREGROUND,    // The app was already running when the alert was due
+  ALERT_PATH_WAKEUP_LAUNCH, // A wakeup launched the app after the alert was due
+  ALERT_PATH_OTHER_LAUNCH,  // The app was launched some other way after the alert was due
+  ALERT_NUM_PATHS
+};
+
+#define ALERT_LATENCY_NUM_BUCKETS 11
+
+// Load the histogram and note how the app launched. Should be called at startup.
+void alert_latency_init();
+// Save the histogram. Should be called when the app is exiting.
+void alert_latency_deinit();
+// Count an alert that is vibrating now for the deadline that fired at due_time,
+// in seconds since the epoch: the end of the timer for its elapse, or the time
+// of the nudge. Alerts that aren't due, like a launch repeating one that
+// already happened, must not be counted.
+void alert_latency_record(int due_time);
+void alert_latency_reset();
+
+int alert_latency_get_count(enum Alert_path path, int bucket);
+// Largest lateness seen on the path, in milliseconds
+int alert_latency_get_max_ms(enum Alert_path path);
+const char* alert_latency_get_path_name(enum Alert_path path);
+const char* alert_latency_get_bucket_name(int bucket);
+
+// Write the histogram to the app log
+void alert_latency_log();
+
+#endif /*ALERT_LATENCY_H*/
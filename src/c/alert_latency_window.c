@@ -0,0 +1,132 @@
+#include "alert_latency_window.h"
+
+#ifndef NDEBUG
+
+#include "alert_latency.h"
+#include "draw_utility.h"
+#include "globals.h"
+#include "assert.h"
+#include "Utility.h"
+
+#include <pebble.h>
+
+static Window* s_alert_latency_window;
+static MenuLayer* s_menu_layer;
+static StatusBarLayer* s_status_bar_layer;
+
+// WindowHandlers
+static void window_load_handler(Window* window);
+static void window_unload_handler(Window* window);
+
+// MenuLayerCallbacks
+static uint16_t menu_get_num_sections_callback(MenuLayer* menu_layer, void* data);
+static uint16_t menu_get_num_rows_callback(MenuLayer* menu_layer, uint16_t section_index, void* data);
+static int16_t menu_get_header_height_callback(MenuLayer* menu_layer, uint16_t section_index, void* data);
+static void menu_draw_row_callback(GContext* ctx, const Layer* cell_layer, MenuIndex* cell_index, void* data);
+static void menu_draw_header_callback(GContext* ctx, const Layer* cell_layer, uint16_t section_index, void* data);
+static void menu_select_click_callback(MenuLayer* menu_layer, MenuIndex* cell_index, void* data);
+static void menu_select_long_click_callback(MenuLayer* menu_layer, MenuIndex* cell_index, void* data);
+
+void alert_latency_window_push()
+{
+  s_alert_latency_window = window_create();
+
+  assert(s_alert_latency_window);
+
+  window_set_window_handlers(s_alert_latency_window, (WindowHandlers) {
+    .load = window_load_handler,
+    .unload = window_unload_handler
+  });
+
+  window_stack_push(s_alert_latency_window, false);
+}
+
+// WindowHandlers
+static void window_load_handler(Window* window)
+{
+  Layer* window_layer = window_get_root_layer(window);
+
+  // Status bar layer
+  s_status_bar_layer = status_bar_create();
+  layer_add_child(window_layer, status_bar_layer_get_layer(s_status_bar_layer));
+
+  // Menu layer
+  GRect bounds = layer_get_bounds(window_layer);
+  bounds = status_bar_adjust_window_bounds(bounds);
+  s_menu_layer = menu_layer_create(bounds);
+  assert(s_menu_layer);
+
+  menu_layer_set_callbacks(s_menu_layer, NULL, (MenuLayerCallbacks) {
+    .get_num_sections = menu_get_num_sections_callback,
+    .get_num_rows = menu_get_num_rows_callback,
+    .get_cell_height = PBL_IF_ROUND_ELSE(menu_cell_get_height_round, NULL),
+    .get_header_height = menu_get_header_height_callback,
+    .draw_header = menu_draw_header_callback,
+    .draw_row = menu_draw_row_callback,
+    .select_click = menu_select_click_callback,
+    .select_long_click = menu_select_long_click_callback
+  });
+
+  menu_layer_set_click_config_onto_window(s_menu_layer, window);
+
+  layer_add_child(window_layer, menu_layer_get_layer(s_menu_layer));
+}
+
+static void window_unload_handler(Window* window)
+{
+  menu_layer_destroy(s_menu_layer);
+  s_menu_layer = NULL;
+
+  status_bar_layer_destroy(s_status_bar_layer);
+  s_status_bar_layer = NULL;
+
+  window_destroy(s_alert_latency_window);
+  s_alert_latency_window = NULL;
+}
+
+// MenuLayerCallbacks
+static uint16_t menu_get_num_sections_callback(MenuLayer* menu_layer, void* data)
+{
+  return ALERT_NUM_PATHS;
+}
+
+static uint16_t menu_get_num_rows_callback(MenuLayer* menu_layer, uint16_t section_index, void* data)
+{
+  return ALERT_LATENCY_NUM_BUCKETS;
+}
+
+static int16_t menu_get_header_height_callback(MenuLayer* menu_layer, uint16_t section_index, void* data)
+{
+  return MENU_CELL_BASIC_HEADER_HEIGHT;
+}
+
+static void menu_draw_row_callback(GContext* ctx, const Layer* cell_layer, MenuIndex* cell_index, void* data)
+{
+  assert(in_range(cell_index->section, 0, ALERT_NUM_PATHS));
+  char count_text[MENU_TEXT_LENGTH];
+  snprintf(count_text, sizeof(count_text), "%d alerts",
+    alert_latency_get_count(cell_index->section, cell_index->row));
+  menu_cell_basic_draw(ctx, cell_layer, alert_latency_get_bucket_name(cell_index->row), count_text, NULL);
+}
+
+static void menu_draw_header_callback(GContext* ctx, const Layer* cell_layer, uint16_t section_index, void* data)
+{
+  assert(in_range(section_index, 0, ALERT_NUM_PATHS));
+  char header_text[MENU_TEXT_LENGTH];
+  snprintf(header_text, sizeof(header_text), "%s, max %d ms", alert_latency_get_path_name(section_index),
+    alert_latency_get_max_ms(section_index));
+  menu_cell_draw_header(ctx, cell_layer, header_text);
+}
+
+static void menu_select_click_callback(MenuLayer* menu_layer, MenuIndex* cell_index, void* data)
+{
+  alert_latency_log();
+}
+
+static void menu_select_long_click_callback(MenuLayer* menu_layer, MenuIndex* cell_index, void* data)
+{
+  alert_latency_reset();
+  layer_mark_dirty(menu_layer_get_layer(s_menu_layer));
+}
+
+#endif /* NDEBUG */
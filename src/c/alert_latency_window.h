@@ -0,0 +1,12 @@
+#ifndef ALERT_LATENCY_WINDOW_H
+#define ALERT_LATENCY_WINDOW_H
+
+#ifndef NDEBUG
+/*
+Push the debug window that shows the alert latency histogram. Select writes
+it to the app log, long select resets it.
+*/
+void alert_latency_window_push();
+#endif /* NDEBUG */
+
+#endif /*ALERT_LATENCY_WINDOW_H*/
@@ -0,0 +1,299 @@
+#include "dashboard_window.h"
+#include "App_data.h"
+#include "List.h"
+#include "Utility.h"
+#include "Timer.h"
+#include "Timer_group.h"
+#include "globals.h"
+#include "assert.h"
+#include "draw_utility.h"
+#include "timer_countdown_window.h"
+#include "Model_events.h"
+#include "window_cache.h"
+#include "profile.h"
+#include "energy.h"
+
+#include <pebble.h>
+
+#define DONE_TEXT "Done"
+
+// One running timer
+struct Dashboard_row {
+  int timer_group_index;
+  int timer_index;
+  int end_time;       // When the timer elapses, in seconds since the epoch
+  int shown_remaining; // Seconds left that remaining_text shows
+  char remaining_text[TIMER_TEXT_LENGTH];
+  char subtitle_text[MENU_TEXT_LENGTH];
+};
+
+// What the menu shows, so its callbacks don't go through the app data
+struct View_model {
+  bool stale;                 // Timers started, stopped or changed since the rows were built
+  int num_rows;
+  struct Dashboard_row* rows;
+};
+
+static Window* s_dashboard_window;
+static MenuLayer* s_menu_layer;
+static StatusBarLayer* s_status_bar_layer;
+static struct View_model s_view_model;
+static int s_model_events_handle = INVALID_INDEX;
+// Refreshes the whole dashboard while it's on top of the window stack
+static AppTimer* s_tick_handle = NULL;
+
+// WindowHandlers
+static void window_load_handler(Window* window);
+static void window_appear_handler(Window* window);
+static void window_disappear_handler(Window* window);
+static void window_unload_handler(Window* window);
+
+// MenuLayerCallbacks
+static uint16_t menu_get_num_rows_callback(MenuLayer* menu_layer, uint16_t section_index, void* data);
+static void menu_draw_row_callback(GContext* ctx, const Layer* cell_layer, MenuIndex* cell_index, void* data);
+static void menu_select_click_callback(MenuLayer* menu_layer, MenuIndex* cell_index, void* data);
+
+// Helpers
+static void create_layers(Window* window);
+// Destroy the window and its layers
+static void destroy_window(Window* window);
+static void model_event_handler(const struct Model_event_data* event_data, void* context);
+// Rebuild the rows from the running timers
+static void update_view_model();
+// Bring the remaining text of each row up to date. Return true if any changed.
+static bool update_remaining_texts(int current_time);
+
+// Tick
+// Refresh the dashboard after delay, then every second while a timer runs
+static void start_tick(int delay);
+static void stop_tick();
+static void tick_handler(void* data);
+
+void dashboard_window_push()
+{
+  if (!s_dashboard_window) {
+    s_dashboard_window = window_create();
+
+    assert(s_dashboard_window);
+
+    window_set_window_handlers(s_dashboard_window, (WindowHandlers) {
+      .load = window_load_handler,
+      .appear = window_appear_handler,
+      .disappear = window_disappear_handler,
+      .unload = window_unload_handler
+    });
+  }
+  window_cache_take(s_dashboard_window);
+
+  window_stack_push(s_dashboard_window, false);
+}
+
+// WindowHandlers
+static void window_load_handler(Window* window)
+{
+  if (!s_menu_layer) {
+    create_layers(window);
+  }
+  menu_layer_set_click_config_onto_window(s_menu_layer, window);
+
+  s_view_model = (struct View_model) {
+    .stale = true,
+    .num_rows = 0,
+    .rows = NULL
+  };
+  s_model_events_handle = model_events_subscribe(model_event_handler, NULL);
+}
+
+static void create_layers(Window* window)
+{
+  Layer* window_layer = window_get_root_layer(window);
+
+  // Status bar layer
+  s_status_bar_layer = status_bar_create();
+  layer_add_child(window_layer, status_bar_layer_get_layer(s_status_bar_layer));
+
+  // Menu layer
+  GRect bounds = layer_get_bounds(window_layer);
+  bounds = status_bar_adjust_window_bounds(bounds);
+  s_menu_layer = menu_layer_create(bounds);
+  assert(s_menu_layer);
+
+  menu_layer_set_callbacks(s_menu_layer, NULL, (MenuLayerCallbacks) {
+    .get_num_rows = menu_get_num_rows_callback,
+    .get_cell_height = PBL_IF_ROUND_ELSE(menu_cell_get_height_round, NULL),
+    .draw_row = menu_draw_row_callback,
+    .select_click = menu_select_click_callback
+  });
+
+  layer_add_child(window_layer, menu_layer_get_layer(s_menu_layer));
+}
+
+static void window_appear_handler(Window* window)
+{
+  // Catch up right away so the first frame is current
+  stop_tick();
+  tick_handler(NULL);
+}
+
+static void window_disappear_handler(Window* window)
+{
+  stop_tick();
+}
+
+static void window_unload_handler(Window* window)
+{
+  model_events_unsubscribe(s_model_events_handle);
+  s_model_events_handle = INVALID_INDEX;
+
+  free(s_view_model.rows);
+  s_view_model.rows = NULL;
+  s_view_model.num_rows = 0;
+
+  window_cache_release(s_dashboard_window, destroy_window);
+}
+
+static void destroy_window(Window* window)
+{
+  menu_layer_destroy(s_menu_layer);
+  s_menu_layer = NULL;
+
+  status_bar_layer_destroy(s_status_bar_layer);
+  s_status_bar_layer = NULL;
+
+  window_destroy(s_dashboard_window);
+  s_dashboard_window = NULL;
+}
+
+// MenuLayerCallbacks
+static uint16_t menu_get_num_rows_callback(MenuLayer* menu_layer, uint16_t section_index, void* data)
+{
+  // One row saying there's nothing running
+  return s_view_model.num_rows > 0 ? s_view_model.num_rows : 1;
+}
+
+static void menu_draw_row_callback(GContext* ctx, const Layer* cell_layer, MenuIndex* cell_index, void* data)
+{
+  energy_count(ENERGY_COUNTER_REDRAW);
+  if (s_view_model.num_rows == 0) {
+    menu_cell_basic_draw(ctx, cell_layer, "No timers running", NULL, NULL);
+    return;
+  }
+  assert(in_range(cell_index->row, 0, s_view_model.num_rows));
+  struct Dashboard_row* row = &s_view_model.rows[cell_index->row];
+  menu_cell_basic_draw(ctx, cell_layer, row->remaining_text, row->subtitle_text, NULL);
+}
+
+static void menu_select_click_callback(MenuLayer* menu_layer, MenuIndex* cell_index, void* data)
+{
+  if (!in_range(cell_index->row, 0, s_view_model.num_rows)) {
+    return;
+  }
+  struct Dashboard_row* row = &s_view_model.rows[cell_index->row];
+  timer_countdown_window_push(row->timer_group_index, row->timer_index);
+}
+
+// Helpers
+static void model_event_handler(const struct Model_event_data* event_data, void* context)
+{
+  if (event_data->event == MODEL_EVENT_SETTINGS_CHANGED) {
+    return;
+  }
+  s_view_model.stale = true;
+  if (window_stack_get_top_window() == s_dashboard_window) {
+    // Rebuild once after the whole change, e.g. a group progressing resets
+    // one timer and starts the next
+    start_tick(0);
+  }
+}
+
+static void update_view_model()
+{
+  struct List* timer_groups = app_data_get_timer_groups(app_data_get());
+  int num_rows = 0;
+  for (int i = 0; i < list_size(timer_groups); ++i) {
+    struct Timer_group* timer_group = list_get(timer_groups, i);
+    for (int j = 0; j < timer_group_size(timer_group); ++j) {
+      num_rows += timer_is_running(timer_group_get_timer(timer_group, j)) ? 1 : 0;
+    }
+  }
+  if (num_rows != s_view_model.num_rows) {
+    free(s_view_model.rows);
+    s_view_model.rows = num_rows > 0 ? safe_alloc(num_rows * sizeof(struct Dashboard_row)) : NULL;
+    s_view_model.num_rows = num_rows;
+  }
+  int row_index = 0;
+  for (int i = 0; i < list_size(timer_groups); ++i) {
+    struct Timer_group* timer_group = list_get(timer_groups, i);
+    for (int j = 0; j < timer_group_size(timer_group); ++j) {
+      struct Timer* timer = timer_group_get_timer(timer_group, j);
+      if (!timer_is_running(timer)) {
+        continue;
+      }
+      struct Dashboard_row* row = &s_view_model.rows[row_index++];
+      row->timer_group_index = i;
+      row->timer_index = j;
+      row->end_time = timer_get_end_time(timer);
+      row->shown_remaining = -1;
+      snprintf(row->subtitle_text, sizeof(row->subtitle_text), "Group %d, timer %d of %d",
+        i + 1, j + 1, timer_group_size(timer_group));
+    }
+  }
+  s_view_model.stale = false;
+}
+
+static bool update_remaining_texts(int current_time)
+{
+  bool changed = false;
+  for (int i = 0; i < s_view_model.num_rows; ++i) {
+    struct Dashboard_row* row = &s_view_model.rows[i];
+    int remaining = max(row->end_time - current_time, 0);
+    if (remaining == row->shown_remaining) {
+      continue;
+    }
+    if (remaining > 0) {
+      get_duration_text(row->remaining_text, sizeof(row->remaining_text), remaining);
+    } else {
+      strncpy(row->remaining_text, DONE_TEXT, sizeof(row->remaining_text));
+    }
+    row->shown_remaining = remaining;
+    changed = true;
+  }
+  return changed;
+}
+
+// Tick
+static void start_tick(int delay)
+{
+  stop_tick();
+  s_tick_handle = app_timer_register(delay, tick_handler, NULL);
+}
+
+static void stop_tick()
+{
+  if (s_tick_handle) {
+    app_timer_cancel(s_tick_handle);
+    s_tick_handle = NULL;
+  }
+}
+
+static void tick_handler(void* data)
+{
+  energy_count(ENERGY_COUNTER_APP_TIMER);
+  s_tick_handle = NULL;
+  PROFILE_BEGIN(dashboard_tick);
+  if (s_view_model.stale) {
+    update_view_model();
+    menu_layer_reload_data(s_menu_layer);
+  }
+  int current_time = time(NULL);
+  if (update_remaining_texts(current_time)) {
+    layer_mark_dirty(menu_layer_get_layer(s_menu_layer));
+  }
+  PROFILE_END(dashboard_tick);
+  for (int i = 0; i < s_view_model.num_rows; ++i) {
+    if (s_view_model.rows[i].end_time > current_time) {
+      s_tick_handle = app_timer_register(MS_PER_SECOND, tick_handler, NULL);
+      return;
+    }
+  }
+}
@@ -0,0 +1,10 @@
+#ifndef DASHBOARD_WINDOW_H
+#define DASHBOARD_WINDOW_H
+
+/*
+Push the window that lists every running timer, including elapsed timers that
+wait for the user, across all groups with their time left.
+*/
+void dashboard_window_push();
+
+#endif /*DASHBOARD_WINDOW_H*/
@@ -1,13 +1,53 @@
 #include "draw_utility.h"
 #include "assert.h"
 #include "globals.h"
+#include "Utility.h"
+#include "Time_format.h"
+#include "energy.h"
 
 #include <pebble.h>
 
+// Longest text a countdown layer shows, e.g. "99:59:59"
+#define COUNTDOWN_TEXT_LENGTH 8
+
+struct Countdown_layer {
+  Layer* layer;
+  GFont font;
+  char text[COUNTDOWN_TEXT_LENGTH + 1];
+};
+
+#ifdef PBL_ROUND
+// One step per minute mark
+#define PROGRESS_RING_STEPS 60
+#define PROGRESS_RING_WIDTH 6
+#else
+#define PROGRESS_BAR_HEIGHT 6
+#endif
+
+struct Progress_layer {
+  Layer* layer;
+  GSize size;        // Layer size the geometry was computed for
+  int num_steps;
+  int filled_steps;
+  int elapsed_seconds;
+  int total_seconds;
+#ifndef PBL_ROUND
+  GRect bar;         // Outline of the bar; each step is one pixel column
+#endif
+};
+
 #ifdef PBL_ROUND
 static void menu_cell_draw_header_centered(GContext* ctx, const Layer* cell_layer, const char* text);
 #endif
 
+// Countdown layer
+static void countdown_layer_update_proc(Layer* layer, GContext* ctx);
+
+// Progress layer
+static void progress_layer_layout(struct Progress_layer* progress_layer);
+static int progress_layer_get_filled_steps(const struct Progress_layer* progress_layer);
+static void progress_layer_update_proc(Layer* layer, GContext* ctx);
+
 void menu_cell_draw_header(GContext* ctx, const Layer* cell_layer, const char* text)
 {
   assert(ctx);
@@ -45,17 +85,91 @@ int16_t menu_cell_get_height_round(MenuLayer* menu_layer, MenuIndex* cell_index,
 }
 #endif
 
-void get_timer_text(char* buf, int buf_size, int hours, int minutes,
+int get_timer_text(char* buf, int buf_size, int hours, int minutes,
   int seconds)
 {
   assert(buf);
-  if (hours > 0) {
-    snprintf(buf, buf_size, "%d:%.2d:%.2d", hours, minutes, seconds);
-  } else if (minutes > 0) {
-    snprintf(buf, buf_size, "%d:%.2d", minutes, seconds);
-  } else {
-    snprintf(buf, buf_size, ":%.2d", seconds);
+  return time_format_compact(buf, buf_size, hours, minutes, seconds);
+}
+
+int get_duration_text(char* buf, int buf_size, int duration_seconds)
+{
+  assert(buf);
+  return time_format_compact_seconds(buf, buf_size, duration_seconds);
+}
+
+struct Countdown_layer* countdown_layer_create(GRect frame, GFont font)
+{
+  struct Countdown_layer* countdown_layer = safe_alloc(sizeof(struct Countdown_layer));
+  countdown_layer->layer = layer_create_with_data(frame, sizeof(struct Countdown_layer*));
+  *(struct Countdown_layer**) layer_get_data(countdown_layer->layer) = countdown_layer;
+  layer_set_update_proc(countdown_layer->layer, countdown_layer_update_proc);
+  countdown_layer->font = font;
+  countdown_layer->text[0] = '\0';
+  return countdown_layer;
+}
+
+void countdown_layer_destroy(struct Countdown_layer* countdown_layer)
+{
+  assert(countdown_layer);
+  layer_destroy(countdown_layer->layer);
+  free(countdown_layer);
+}
+
+Layer* countdown_layer_get_layer(const struct Countdown_layer* countdown_layer)
+{
+  assert(countdown_layer);
+  return countdown_layer->layer;
+}
+
+void countdown_layer_set_text(struct Countdown_layer* countdown_layer, const char* text)
+{
+  assert(countdown_layer);
+  assert(text);
+  if (strncmp(countdown_layer->text, text, COUNTDOWN_TEXT_LENGTH) == 0) {
+    return;
   }
+  strncpy(countdown_layer->text, text, COUNTDOWN_TEXT_LENGTH);
+  countdown_layer->text[COUNTDOWN_TEXT_LENGTH] = '\0';
+  layer_mark_dirty(countdown_layer->layer);
+}
+
+struct Progress_layer* progress_layer_create(GRect frame)
+{
+  struct Progress_layer* progress_layer = safe_alloc(sizeof(struct Progress_layer));
+  progress_layer->layer = layer_create_with_data(frame, sizeof(struct Progress_layer*));
+  *(struct Progress_layer**) layer_get_data(progress_layer->layer) = progress_layer;
+  layer_set_update_proc(progress_layer->layer, progress_layer_update_proc);
+  progress_layer->elapsed_seconds = 0;
+  progress_layer->total_seconds = 0;
+  progress_layer_layout(progress_layer);
+  return progress_layer;
+}
+
+void progress_layer_destroy(struct Progress_layer* progress_layer)
+{
+  assert(progress_layer);
+  layer_destroy(progress_layer->layer);
+  free(progress_layer);
+}
+
+Layer* progress_layer_get_layer(const struct Progress_layer* progress_layer)
+{
+  assert(progress_layer);
+  return progress_layer->layer;
+}
+
+void progress_layer_set_progress(struct Progress_layer* progress_layer, int elapsed_seconds, int total_seconds)
+{
+  assert(progress_layer);
+  progress_layer->elapsed_seconds = elapsed_seconds;
+  progress_layer->total_seconds = total_seconds;
+  int filled_steps = progress_layer_get_filled_steps(progress_layer);
+  if (filled_steps == progress_layer->filled_steps) {
+    return;
+  }
+  progress_layer->filled_steps = filled_steps;
+  layer_mark_dirty(progress_layer->layer);
 }
 
 StatusBarLayer* status_bar_create()
@@ -70,3 +184,66 @@ GRect status_bar_adjust_window_bounds(GRect bounds)
   bounds.size.h -= STATUS_BAR_LAYER_HEIGHT;
   return bounds;
 }
+
+// Countdown layer
+static void countdown_layer_update_proc(Layer* layer, GContext* ctx)
+{
+  energy_count(ENERGY_COUNTER_REDRAW);
+  struct Countdown_layer* countdown_layer = *(struct Countdown_layer**) layer_get_data(layer);
+  GRect bounds = layer_get_bounds(layer);
+  graphics_context_set_fill_color(ctx, GColorWhite);
+  graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+  graphics_context_set_text_color(ctx, GColorBlack);
+  graphics_draw_text(ctx, countdown_layer->text, countdown_layer->font, bounds, GTextOverflowModeWordWrap,
+    GTextAlignmentCenter, NULL);
+}
+
+// Progress layer
+static void progress_layer_layout(struct Progress_layer* progress_layer)
+{
+  GRect bounds = layer_get_bounds(progress_layer->layer);
+  progress_layer->size = bounds.size;
+#ifdef PBL_ROUND
+  progress_layer->num_steps = PROGRESS_RING_STEPS;
+#else
+  progress_layer->bar = GRect(0, (bounds.size.h - PROGRESS_BAR_HEIGHT) / 2, bounds.size.w, PROGRESS_BAR_HEIGHT);
+  // Inside the outline
+  progress_layer->num_steps = max(bounds.size.w - 2, 0);
+#endif
+  progress_layer->filled_steps = progress_layer_get_filled_steps(progress_layer);
+}
+
+static int progress_layer_get_filled_steps(const struct Progress_layer* progress_layer)
+{
+  if (progress_layer->total_seconds <= 0) {
+    return 0;
+  }
+  int elapsed_seconds = min(max(progress_layer->elapsed_seconds, 0), progress_layer->total_seconds);
+  return elapsed_seconds * progress_layer->num_steps / progress_layer->total_seconds;
+}
+
+static void progress_layer_update_proc(Layer* layer, GContext* ctx)
+{
+  energy_count(ENERGY_COUNTER_REDRAW);
+  struct Progress_layer* progress_layer = *(struct Progress_layer**) layer_get_data(layer);
+  GRect bounds = layer_get_bounds(layer);
+  if (bounds.size.w != progress_layer->size.w || bounds.size.h != progress_layer->size.h) {
+    progress_layer_layout(progress_layer);
+  }
+#ifdef PBL_ROUND
+  // The whole filled arc in one call, clockwise from the top
+  if (progress_layer->filled_steps > 0) {
+    graphics_context_set_fill_color(ctx, GColorBlack);
+    graphics_fill_radial(ctx, bounds, GOvalScaleModeFitCircle, PROGRESS_RING_WIDTH, 0,
+      TRIG_MAX_ANGLE * progress_layer->filled_steps / progress_layer->num_steps);
+  }
+#else
+  graphics_context_set_stroke_color(ctx, GColorBlack);
+  graphics_draw_rect(ctx, progress_layer->bar);
+  if (progress_layer->filled_steps > 0) {
+    graphics_context_set_fill_color(ctx, GColorBlack);
+    graphics_fill_rect(ctx, GRect(progress_layer->bar.origin.x + 1, progress_layer->bar.origin.y + 1,
+      progress_layer->filled_steps, progress_layer->bar.size.h - 2), 0, GCornerNone);
+  }
+#endif
+}
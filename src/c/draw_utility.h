@@ -7,7 +7,36 @@ void menu_cell_draw_header(GContext* ctx, const Layer* cell_layer, const char* t
 
 int16_t menu_cell_get_height_round(MenuLayer* menu_layer, MenuIndex* cell_index, void* data);
 
-void get_timer_text(char* buf, int buf_size, int hours, int minutes, int seconds);
+// Write "1:02:03", "2:03" or ":03" and return its length; see Time_format.h
+int get_timer_text(char* buf, int buf_size, int hours, int minutes, int seconds);
+// Same as get_timer_text, for a duration in seconds
+int get_duration_text(char* buf, int buf_size, int duration_seconds);
+
+/*
+Layer that shows a timer text like "1:02:03", black on white and centered
+like the TextLayer it replaces. It is only marked dirty when the text changes,
+so ticks that show the same text, e.g. while paused, draw nothing.
+*/
+struct Countdown_layer;
+struct Countdown_layer* countdown_layer_create(GRect frame, GFont font);
+void countdown_layer_destroy(struct Countdown_layer* countdown_layer);
+Layer* countdown_layer_get_layer(const struct Countdown_layer* countdown_layer);
+// Nothing is marked dirty if the text didn't change
+void countdown_layer_set_text(struct Countdown_layer* countdown_layer, const char* text);
+
+/*
+Layer that shows how much of a timer has passed: a ring around the edge of
+round displays, a bar elsewhere. The shape is split into steps, and the layer
+is only marked dirty when the number of filled steps changes, so most ticks of
+a long timer draw nothing. A redraw draws the whole filled part, since the SDK
+redraws a dirty layer in full.
+*/
+struct Progress_layer;
+struct Progress_layer* progress_layer_create(GRect frame);
+void progress_layer_destroy(struct Progress_layer* progress_layer);
+Layer* progress_layer_get_layer(const struct Progress_layer* progress_layer);
+// Nothing is marked dirty if the number of filled steps didn't change
+void progress_layer_set_progress(struct Progress_layer* progress_layer, int elapsed_seconds, int total_seconds);
 
 StatusBarLayer* status_bar_create();
 GRect status_bar_adjust_window_bounds(GRect bounds);
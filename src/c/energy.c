@@ -0,0 +1,134 @@
+#include "energy.h"
+#include "Settings.h"
+#include "Utility.h"
+#include "assert.h"
+
+#include <pebble.h>
+
+// Saved as is, so changing it drops the saved sessions through the size check
+struct Energy_session {
+  uint32_t start_time;     // Seconds since the epoch
+  uint32_t duration;       // In seconds
+  uint32_t counters[ENERGY_NUM_COUNTERS];
+  // By the styles of the group each was for. These stop at UINT16_MAX.
+  uint16_t vibrations_by_progress_style[PROGRESS_STYLE_INVALID];
+  uint16_t vibrations_by_vibrate_style[VIBRATE_STYLE_INVALID];
+  uint16_t nudge_wakeups_by_vibrate_style[VIBRATE_STYLE_INVALID];
+};
+
+static const char* const s_counter_names[ENERGY_NUM_COUNTERS] = {
+  [ENERGY_COUNTER_APP_TIMER] = "app timers",
+  [ENERGY_COUNTER_REDRAW] = "redraws",
+  [ENERGY_COUNTER_WAKEUP_SCHEDULE] = "wakeups scheduled",
+  [ENERGY_COUNTER_WAKEUP_CANCEL] = "wakeups cancelled",
+  [ENERGY_COUNTER_WAKEUP_LAUNCH] = "wakeup launches",
+  [ENERGY_COUNTER_VIBRATION] = "vibrations",
+  [ENERGY_COUNTER_PERSIST_WRITE] = "persist writes",
+  [ENERGY_COUNTER_PERSIST_BYTES] = "persist bytes"
+};
+
+static struct Energy_session s_session;
+
+// Helpers
+// Read the saved sessions, newest first. Return how many there are.
+static int load_sessions(struct Energy_session sessions[ENERGY_NUM_SESSIONS]);
+static void log_session(const char* label, const struct Energy_session* session);
+static void add_style_count(uint16_t* count, int amount);
+
+void energy_init()
+{
+  memset(&s_session, 0, sizeof(s_session));
+  s_session.start_time = time(NULL);
+}
+
+void energy_deinit()
+{
+  s_session.duration = time(NULL) - s_session.start_time;
+  struct Energy_session sessions[ENERGY_NUM_SESSIONS];
+  int num_sessions = load_sessions(sessions);
+  // Drop the oldest to make room
+  memmove(&sessions[1], &sessions[0], min(num_sessions, ENERGY_NUM_SESSIONS - 1) * sizeof(struct Energy_session));
+  sessions[0] = s_session;
+  num_sessions = min(num_sessions + 1, ENERGY_NUM_SESSIONS);
+  persist_write_data(ENERGY_PERSIST_KEY, sessions, num_sessions * sizeof(struct Energy_session));
+}
+
+void energy_count(enum Energy_counter counter)
+{
+  energy_add(counter, 1);
+}
+
+void energy_add(enum Energy_counter counter, int amount)
+{
+  assert(in_range(counter, 0, ENERGY_NUM_COUNTERS));
+  s_session.counters[counter] += amount;
+}
+
+void energy_count_vibration(const struct Settings* settings)
+{
+  assert(settings);
+  energy_count(ENERGY_COUNTER_VIBRATION);
+  add_style_count(&s_session.vibrations_by_progress_style[settings_get_progress_style(settings)], 1);
+  add_style_count(&s_session.vibrations_by_vibrate_style[settings_get_vibrate_style(settings)], 1);
+}
+
+void energy_add_nudge_wakeups(const struct Settings* settings, int amount)
+{
+  assert(settings);
+  add_style_count(&s_session.nudge_wakeups_by_vibrate_style[settings_get_vibrate_style(settings)], amount);
+}
+
+void energy_log()
+{
+  struct Energy_session current = s_session;
+  current.duration = time(NULL) - current.start_time;
+  log_session("Current session", &current);
+  struct Energy_session sessions[ENERGY_NUM_SESSIONS];
+  int num_sessions = load_sessions(sessions);
+  for (int i = 0; i < num_sessions; ++i) {
+    char label[16];
+    snprintf(label, sizeof(label), "Session -%d", i + 1);
+    log_session(label, &sessions[i]);
+  }
+}
+
+// Helpers
+static int load_sessions(struct Energy_session sessions[ENERGY_NUM_SESSIONS])
+{
+  int size = persist_get_size(ENERGY_PERSIST_KEY);
+  if (size <= 0 || size % sizeof(struct Energy_session) != 0 ||
+      size > (int) (ENERGY_NUM_SESSIONS * sizeof(struct Energy_session))) {
+    return 0;
+  }
+  if (persist_read_data(ENERGY_PERSIST_KEY, sessions, size) != size) {
+    return 0;
+  }
+  return size / sizeof(struct Energy_session);
+}
+
+static void log_session(const char* label, const struct Energy_session* session)
+{
+  APP_LOG(APP_LOG_LEVEL_INFO, "%s: %lu s", label, (unsigned long) session->duration);
+  for (int i = 0; i < ENERGY_NUM_COUNTERS; ++i) {
+    APP_LOG(APP_LOG_LEVEL_INFO, "  %s: %lu", s_counter_names[i], (unsigned long) session->counters[i]);
+  }
+  // Only the styles that fired
+  for (int i = 0; i < PROGRESS_STYLE_INVALID; ++i) {
+    if (session->vibrations_by_progress_style[i]) {
+      APP_LOG(APP_LOG_LEVEL_INFO, "  vibrations, %s: %lu", settings_get_progress_style_text(i),
+        (unsigned long) session->vibrations_by_progress_style[i]);
+    }
+  }
+  for (int i = 0; i < VIBRATE_STYLE_INVALID; ++i) {
+    if (session->vibrations_by_vibrate_style[i] || session->nudge_wakeups_by_vibrate_style[i]) {
+      APP_LOG(APP_LOG_LEVEL_INFO, "  vibrations, %s: %lu, nudge wakeups: %lu", settings_get_vibrate_style_text(i),
+        (unsigned long) session->vibrations_by_vibrate_style[i],
+        (unsigned long) session->nudge_wakeups_by_vibrate_style[i]);
+    }
+  }
+}
+
+static void add_style_count(uint16_t* count, int amount)
+{
+  *count = min(*count + amount, UINT16_MAX);
+}
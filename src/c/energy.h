@@ -0,0 +1,47 @@
+#ifndef ENERGY_H
+#define ENERGY_H
+
+struct Settings;
+
+/*
+Counts the things that cost battery, per session (one launch of the app).
+Vibrations and nudge wakeups are also counted by the styles of the group they
+were for, so settings can be compared. The last ENERGY_NUM_SESSIONS sessions
+are persisted.
+*/
+
+// Persist key of the saved sessions, above the alert latency key
+#define ENERGY_PERSIST_KEY 400000
+// Sessions kept; they fill one persist key
+#define ENERGY_NUM_SESSIONS 3
+
+// Saved as numbers, so only append
+enum Energy_counter {
+  ENERGY_COUNTER_APP_TIMER,       // App timer callbacks
+  ENERGY_COUNTER_REDRAW,          // Layer and menu row redraws
+  ENERGY_COUNTER_WAKEUP_SCHEDULE, // wakeup_schedule calls
+  ENERGY_COUNTER_WAKEUP_CANCEL,   // wakeup_cancel and wakeup_cancel_all calls
+  ENERGY_COUNTER_WAKEUP_LAUNCH,   // Launches by a wakeup
+  ENERGY_COUNTER_VIBRATION,
+  ENERGY_COUNTER_PERSIST_WRITE,   // Persist writes of the app data
+  ENERGY_COUNTER_PERSIST_BYTES,   // Bytes those writes stored
+  ENERGY_NUM_COUNTERS
+};
+
+// Start a session. Should be called at startup.
+void energy_init();
+// End the session and save it. Should be called last thing before exiting.
+void energy_deinit();
+
+void energy_count(enum Energy_counter counter);
+void energy_add(enum Energy_counter counter, int amount);
+// Count a vibration for a group with the given settings
+void energy_count_vibration(const struct Settings* settings);
+// Count the times of a nudge series registered as wakeups for a group with the
+// given settings
+void energy_add_nudge_wakeups(const struct Settings* settings, int amount);
+
+// Write this session and the saved ones to the app log
+void energy_log();
+
+#endif /*ENERGY_H*/
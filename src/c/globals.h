@@ -6,9 +6,9 @@
 #define TIMER_TEXT_LENGTH 20
 #define TIMER_TEXT_HEIGHT 80
 #define TIMER_TEXT_HEIGHT_SM 40
+#define PROGRESS_BAR_SPACE 12
+#define PROGRESS_BAR_INSET 10
 #define MS_PER_SECOND 1000
 #define MS_PER_MINUTE 60000
-#define NUDGE_INTERVAL_MS MS_PER_MINUTE
-#define NUDGE_INTERVAL_SECOND (NUDGE_INTERVAL_MS / MS_PER_SECOND)
 
 #endif /*GLOBALS_H*/
@@ -1,7 +1,14 @@
 #include "main_window.h"
 #include "App_data.h"
 #include "Wakeup_manager.h"
+#include "Scheduler.h"
+#include "Work_queue.h"
 #include "persist_util.h"
+#include "window_cache.h"
+#include "trace.h"
+#include "alert_latency.h"
+#include "energy.h"
+#include "profile.h"
 
 #include <pebble.h>
 
@@ -18,12 +25,32 @@ int main()
 
 static void init()
 {
+  PROFILE_BEGIN(init);
+  trace_init();
+  alert_latency_init();
+  energy_init();
   main_window_push();
-  wakeup_manager_handle_wakeup(app_data_get_wakeup_manager(app_data_get()));
+  // Also handles the wakeup that launched the app
+  scheduler_init();
+  PROFILE_END(init);
+#ifndef NDEBUG
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Startup: %d bytes free", (int) heap_bytes_free());
+#endif /* NDEBUG */
 }
 
 static void deinit()
 {
+#ifndef NDEBUG
+  // tools/emulator_scenarios.py reads the profile of each session from here
+  profile_log();
+#endif /* NDEBUG */
+  // Finish scheduling wakeups before they're saved
+  work_queue_flush();
+  window_cache_flush();
+  scheduler_deinit();
   app_data_destroy();
+  alert_latency_deinit();
+  energy_deinit();
+  trace_deinit();
   // persist_delete(PERSIST_VERSION_KEY);
 }
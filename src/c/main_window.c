@@ -5,32 +5,81 @@
 #include "timer_group_window.h"
 #include "timer_countdown_window.h"
 #include "settings_window.h"
+#include "dashboard_window.h"
 #include "globals.h"
 #include "draw_utility.h"
 #include "Timer_group.h"
 #include "assert.h"
 #include "Timer.h"
 #include "Settings.h"
+#include "Scheduler.h"
+#include "Model_events.h"
+#include "profile.h"
+#include "energy.h"
+#include "trace.h"
+#include "alert_latency_window.h"
+#include "test_data.h"
 
 #include <pebble.h>
 
 #define MAIN_MENU_NUM_SECTIONS 2
-#define SUBTITLE_TEXT_LENGTH 100
 
-#define SETTINGS_NUM_ROWS SETTINGS_NUM_ROWS_IMPL
-#ifdef NDEBUG
-#define SETTINGS_NUM_ROWS_IMPL 2
-#else
-#define SETTINGS_NUM_ROWS_IMPL 3
+// Rows of the settings section
+enum Settings_row {
+  SETTINGS_ROW_NEW_GROUP,
+  SETTINGS_ROW_DASHBOARD,
+  SETTINGS_ROW_SETTINGS,
+#ifndef NDEBUG
+  SETTINGS_ROW_GENERATE_DATA,
+  SETTINGS_ROW_STRESS_TEST,
+  SETTINGS_ROW_LOG_PROFILE,
+  SETTINGS_ROW_LOG_TRACE,
+  SETTINGS_ROW_ALERT_LATENCY,
+  SETTINGS_ROW_LOG_ENERGY,
 #endif /* NDEBUG */
+  SETTINGS_NUM_ROWS
+};
+
+static const char* const s_settings_row_texts[SETTINGS_NUM_ROWS] = {
+  [SETTINGS_ROW_NEW_GROUP] = "New Group",
+  [SETTINGS_ROW_DASHBOARD] = "Running Timers",
+  [SETTINGS_ROW_SETTINGS] = "Settings",
+#ifndef NDEBUG
+  [SETTINGS_ROW_GENERATE_DATA] = "Generate data",
+  [SETTINGS_ROW_STRESS_TEST] = "Stress test",
+  [SETTINGS_ROW_LOG_PROFILE] = "Log profile",
+  [SETTINGS_ROW_LOG_TRACE] = "Log trace",
+  [SETTINGS_ROW_ALERT_LATENCY] = "Alert latency",
+  [SETTINGS_ROW_LOG_ENERGY] = "Log energy",
+#endif /* NDEBUG */
+};
+
+// How much of the menu is out of date
+enum View_change {
+  VIEW_CHANGE_NONE,
+  VIEW_CHANGE_TEXT, // Rows show different text
+  VIEW_CHANGE_ROWS  // Groups were added or removed
+};
+
+// What the menu shows, so its callbacks don't go through the app data
+struct View_model {
+  enum View_change pending;          // Not applied yet because the window is hidden
+  int num_timer_groups;
+  struct Timer_group** timer_groups; // Group of each row
+};
 
 static Window* s_main_window;
 static MenuLayer* s_menu_layer;
 static StatusBarLayer* s_status_bar_layer;
+static struct View_model s_view_model;
+static int s_model_events_handle;
+// Keeps what's left of the running groups current while the window is on top
+static AppTimer* s_tick_handle = NULL;
 
 // WindowHandlers
 static void window_load_handler(Window* window);
 static void window_appear_handler(Window* window);
+static void window_disappear_handler(Window* window);
 static void window_unload_handler(Window* window);
 
 // MenuLayerCallbacks
@@ -44,10 +93,21 @@ static void menu_select_long_click_callback(MenuLayer* menu_layer, MenuIndex* ce
 
 // Helpers
 static void menu_cell_draw_timer_group_row(GContext* ctx, const Layer* cell_layer, uint16_t row_index, void* data);
-static void get_subtitle_text(char* buf, int buf_size, const struct Timer_group* timer_group);
-#ifndef NDEBUG
-static void create_test_data();
-#endif /* NDEBUG */
+static struct Timer_group* get_row_timer_group(int row_index);
+static void model_event_handler(const struct Model_event_data* event_data, void* context);
+// Rebuild the rows of the view model from the app data
+static void update_view_model();
+// Record the change and apply it now if the window is showing
+static void view_changed(enum View_change view_change);
+static void apply_view_change();
+// Return true if a timer of any group is running and hasn't elapsed yet
+static bool is_counting_down();
+
+// Tick
+// Redraw the rows every second while a group counts down
+static void start_tick();
+static void stop_tick();
+static void tick_handler(void* data);
 
 void main_window_push()
 {
@@ -58,6 +118,7 @@ void main_window_push()
   window_set_window_handlers(s_main_window, (WindowHandlers) {
     .load = window_load_handler,
     .appear = window_appear_handler,
+    .disappear = window_disappear_handler,
     .unload = window_unload_handler
   });
 
@@ -69,6 +130,7 @@ WindowHandlers
 */
 static void window_load_handler(Window* window)
 {
+  PROFILE_BEGIN(main_window_load);
   Layer* window_layer = window_get_root_layer(window);
 
   // Status bar layer
@@ -95,15 +157,37 @@ static void window_load_handler(Window* window)
   menu_layer_set_click_config_onto_window(s_menu_layer, window);
 
   layer_add_child(window_layer, menu_layer_get_layer(s_menu_layer));
+
+  s_view_model = (struct View_model) {
+    .pending = VIEW_CHANGE_NONE,
+    .num_timer_groups = 0,
+    .timer_groups = NULL
+  };
+  update_view_model();
+  s_model_events_handle = model_events_subscribe(model_event_handler, NULL);
+  PROFILE_END(main_window_load);
 }
 
 static void window_appear_handler(Window* window)
 {
-  menu_layer_reload_data(s_menu_layer);
+  apply_view_change();
+  start_tick();
+}
+
+static void window_disappear_handler(Window* window)
+{
+  stop_tick();
 }
 
 static void window_unload_handler(Window* window)
 {
+  stop_tick();
+  model_events_unsubscribe(s_model_events_handle);
+  s_model_events_handle = INVALID_INDEX;
+
+  free(s_view_model.timer_groups);
+  s_view_model.timer_groups = NULL;
+
   menu_layer_destroy(s_menu_layer);
   s_menu_layer = NULL;
 
@@ -129,7 +213,7 @@ static uint16_t menu_get_num_rows_callback(MenuLayer* menu_layer, uint16_t secti
   switch (section_index) {
     case 0:
       // Timer groups
-      return list_size(app_data_get_timer_groups(app_data_get()));
+      return s_view_model.num_timer_groups;
     case 1:
       // Settings
       return SETTINGS_NUM_ROWS;
@@ -146,32 +230,21 @@ static int16_t menu_get_header_height_callback(MenuLayer* menu_layer, uint16_t s
 
 static void menu_draw_row_callback(GContext* ctx, const Layer* cell_layer, MenuIndex* cell_index, void* data)
 {
+  PROFILE_BEGIN(main_draw_row);
+  energy_count(ENERGY_COUNTER_REDRAW);
   switch (cell_index->section) {
     case 0:
       menu_cell_draw_timer_group_row(ctx, cell_layer, cell_index->row, data);
-      return;
+      break;
     case 1:
-      if (cell_index->row == 0) {
-        // New timer group
-        menu_cell_basic_draw(ctx, cell_layer, "New Group", NULL, NULL);
-        return;
-      }
-      if (cell_index->row == 1) {
-        // Settings
-        menu_cell_basic_draw(ctx, cell_layer, "Settings", NULL, NULL);
-        return;
-      }
-#ifndef NDEBUG
-      if (cell_index->row == 2) {
-        // Create test data
-        menu_cell_basic_draw(ctx, cell_layer, "Create test data", NULL, NULL);
-        return;
-      }
-#endif /* NDEBUG */
+      assert(in_range(cell_index->row, 0, SETTINGS_NUM_ROWS));
+      menu_cell_basic_draw(ctx, cell_layer, s_settings_row_texts[cell_index->row], NULL, NULL);
+      break;
     default:
       APP_LOG(APP_LOG_LEVEL_ERROR, "Invalid section index: %d", cell_index->section);
-      return;
+      break;
   }
+  PROFILE_END(main_draw_row);
 }
 
 static void menu_cell_draw_timer_group_row(GContext* ctx, const Layer* cell_layer, uint16_t row_index, void* data)
@@ -179,44 +252,128 @@ static void menu_cell_draw_timer_group_row(GContext* ctx, const Layer* cell_laye
   assert(ctx);
   assert(cell_layer);
 
-  struct List* timer_groups = app_data_get_timer_groups(app_data_get());
-  assert(in_range(row_index, 0, list_size(timer_groups)));
+  struct Timer_group* timer_group = get_row_timer_group(row_index);
+  const char* subtitle_text = timer_group_get_subtitle_text(timer_group);
+  menu_cell_basic_draw(ctx, cell_layer, timer_group_get_title_text(timer_group),
+    subtitle_text[0] ? subtitle_text : NULL, NULL);
+}
+
+static struct Timer_group* get_row_timer_group(int row_index)
+{
+  assert(in_range(row_index, 0, s_view_model.num_timer_groups));
+  return s_view_model.timer_groups[row_index];
+}
+
+static void model_event_handler(const struct Model_event_data* event_data, void* context)
+{
+  switch (event_data->event) {
+    case MODEL_EVENT_GROUP_ADDED: // intentional fall through
+    case MODEL_EVENT_GROUP_REMOVED:
+      view_changed(VIEW_CHANGE_ROWS);
+      return;
+    case MODEL_EVENT_TIMER_STATE:
+      view_changed(VIEW_CHANGE_TEXT);
+      if (window_stack_get_top_window() == s_main_window) {
+        start_tick();
+      }
+      return;
+    case MODEL_EVENT_TIMER_ADDED: // intentional fall through
+    case MODEL_EVENT_TIMER_REMOVED: // intentional fall through
+    case MODEL_EVENT_TIMER_EDITED: // intentional fall through
+    case MODEL_EVENT_SETTINGS_CHANGED:
+      // Group rows summarize their timers
+      view_changed(VIEW_CHANGE_TEXT);
+      return;
+    case MODEL_EVENT_INVALID: // intentional fall through
+    default:
+      APP_LOG(APP_LOG_LEVEL_ERROR, "Invalid model event: %d", event_data->event);
+      return;
+  }
+}
 
-  struct Timer_group* timer_group = list_get(timer_groups, row_index);
-  assert(timer_group);
+static void update_view_model()
+{
+  struct List* timer_groups = app_data_get_timer_groups(app_data_get());
+  int num_timer_groups = list_size(timer_groups);
+  if (num_timer_groups != s_view_model.num_timer_groups) {
+    free(s_view_model.timer_groups);
+    s_view_model.timer_groups = num_timer_groups > 0 ?
+      safe_alloc(num_timer_groups * sizeof(struct Timer_group*)) : NULL;
+    s_view_model.num_timer_groups = num_timer_groups;
+  }
+  for (int i = 0; i < num_timer_groups; ++i) {
+    s_view_model.timer_groups[i] = list_get(timer_groups, i);
+  }
+}
 
-  char menu_text[MENU_TEXT_LENGTH];
-  int num_timers = timer_group_size(timer_group);
-  char* timer_text = num_timers == 1 ? "Timer" : "Timers";
-  snprintf(menu_text, sizeof(menu_text), "%d %s", num_timers, timer_text);
+static void view_changed(enum View_change view_change)
+{
+  if (view_change > s_view_model.pending) {
+    s_view_model.pending = view_change;
+  }
+  if (window_stack_get_top_window() == s_main_window) {
+    apply_view_change();
+  }
+}
 
-  char subtitle_text[SUBTITLE_TEXT_LENGTH];
-  subtitle_text[0] = '\0';
-  get_subtitle_text(subtitle_text, SUBTITLE_TEXT_LENGTH, timer_group);
-  menu_cell_basic_draw(ctx, cell_layer, menu_text,
-    strlen(subtitle_text) > 0 ? subtitle_text : NULL, NULL);
+static void apply_view_change()
+{
+  switch (s_view_model.pending) {
+    case VIEW_CHANGE_ROWS:
+      update_view_model();
+      menu_layer_reload_data(s_menu_layer);
+      break;
+    case VIEW_CHANGE_TEXT:
+      layer_mark_dirty(menu_layer_get_layer(s_menu_layer));
+      break;
+    case VIEW_CHANGE_NONE: // intentional fall through
+    default:
+      break;
+  }
+  s_view_model.pending = VIEW_CHANGE_NONE;
 }
 
-static void get_subtitle_text(char* buf, int buf_size, const struct Timer_group* timer_group)
+static bool is_counting_down()
 {
-  assert(buf);
-  assert(timer_group);
-  int end_index = 0;
-  char timer_text[TIMER_TEXT_LENGTH];
-
-  for (int i = 0; i < timer_group_size(timer_group) && end_index < buf_size; ++i) {
-    struct Timer* timer = timer_group_get_timer(timer_group, i);
-    get_timer_text(timer_text, sizeof(timer_text),
-        timer_get_field(timer, TIMER_FIELD_HOURS),
-        timer_get_field(timer, TIMER_FIELD_MINUTES),
-        timer_get_field(timer, TIMER_FIELD_SECONDS));
-    end_index += snprintf(buf + end_index, buf_size - end_index, timer_text);
-    if (i < timer_group_size(timer_group) - 1) {
-      end_index += snprintf(buf + end_index, buf_size - end_index, ",  ");
+  for (int i = 0; i < s_view_model.num_timer_groups; ++i) {
+    struct Timer_group* timer_group = s_view_model.timer_groups[i];
+    int timer_index = timer_group_get_running_timer_index(timer_group);
+    if (timer_index < 0) {
+      continue;
+    }
+    struct Timer* timer = timer_group_get_timer(timer_group, timer_index);
+    timer_update(timer);
+    if (!timer_is_elapsed(timer)) {
+      return true;
     }
   }
+  return false;
 }
 
+// Tick
+static void start_tick()
+{
+  if (s_tick_handle || !is_counting_down()) {
+    return;
+  }
+  s_tick_handle = app_timer_register(MS_PER_SECOND, tick_handler, NULL);
+}
+
+static void stop_tick()
+{
+  if (s_tick_handle) {
+    app_timer_cancel(s_tick_handle);
+    s_tick_handle = NULL;
+  }
+}
+
+static void tick_handler(void* data)
+{
+  energy_count(ENERGY_COUNTER_APP_TIMER);
+  s_tick_handle = NULL;
+  layer_mark_dirty(menu_layer_get_layer(s_menu_layer));
+  start_tick();
+}
 
 static void menu_draw_header_callback(GContext* ctx, const Layer* cell_layer, uint16_t section_index, void* data)
 {
@@ -239,32 +396,59 @@ static void menu_select_click_callback(MenuLayer* menu_layer, MenuIndex* cell_in
   switch (cell_index->section) {
     case 0:
       // Timer group
-      assert(in_range(cell_index->row, 0, list_size(app_data_get_timer_groups(app_data_get()))));
+      assert(in_range(cell_index->row, 0, s_view_model.num_timer_groups));
       timer_group_window_push(cell_index->row);
       break;
     case 1:
-      if (cell_index->row == 0) {
-        // New timer group
-        struct List* timer_groups = app_data_get_timer_groups(app_data_get());
-        list_add(timer_groups, timer_group_create());
-        timer_group_window_push(list_size(timer_groups) - 1);
-      } else if (cell_index->row == 1) {
-        // Settings
-        settings_window_push(INVALID_INDEX);
-      }
+      switch ((enum Settings_row) cell_index->row) {
+        case SETTINGS_ROW_NEW_GROUP:
+          app_data_add_timer_group(app_data_get(), timer_group_create());
+          timer_group_window_push(list_size(app_data_get_timer_groups(app_data_get())) - 1);
+          break;
+        case SETTINGS_ROW_DASHBOARD:
+          dashboard_window_push();
+          break;
+        case SETTINGS_ROW_SETTINGS:
+          settings_window_push(INVALID_INDEX);
+          break;
 #ifndef NDEBUG
-      else if (cell_index->row == 2) {
-        create_test_data();
-      }
+        case SETTINGS_ROW_GENERATE_DATA:
+        {
+          struct Data_generator_params params;
+          test_data_default_params(&params, time(NULL));
+          test_data_generate(&params);
+          break;
+        }
+        case SETTINGS_ROW_STRESS_TEST:
+          if (test_data_stress_running()) {
+            test_data_stress_stop();
+          } else {
+            test_data_stress_start();
+          }
+          break;
+        case SETTINGS_ROW_LOG_PROFILE:
+          profile_log();
+          break;
+        case SETTINGS_ROW_LOG_TRACE:
+          trace_log();
+          break;
+        case SETTINGS_ROW_ALERT_LATENCY:
+          alert_latency_window_push();
+          break;
+        case SETTINGS_ROW_LOG_ENERGY:
+          energy_log();
+          break;
 #endif /* NDEBUG */
+        case SETTINGS_NUM_ROWS: // intentional fall through
+        default:
+          APP_LOG(APP_LOG_LEVEL_ERROR, "Invalid row index: %d", cell_index->row);
+          return;
+      }
       break;
     default:
       APP_LOG(APP_LOG_LEVEL_ERROR, "Invalid section index: %d", cell_index->section);
       return;
   }
-  // Refresh window
-  layer_mark_dirty(menu_layer_get_layer(s_menu_layer));
-  menu_layer_reload_data(s_menu_layer);
 }
 
 static void menu_select_long_click_callback(MenuLayer* menu_layer, MenuIndex* cell_index, void* data)
@@ -272,91 +456,14 @@ static void menu_select_long_click_callback(MenuLayer* menu_layer, MenuIndex* ce
   switch (cell_index->section) {
     case 0:
       // Start first timer in group
-      assert(in_range(cell_index->row, 0, list_size(app_data_get_timer_groups(app_data_get()))));
-      if (timer_group_size(app_data_get_timer_group(app_data_get(), cell_index->row)) <= 0) {
+      if (timer_group_size(get_row_timer_group(cell_index->row)) <= 0) {
         break;
       }
-      timer_start(app_data_get_timer(app_data_get(), cell_index->row, 0));
+      scheduler_group_start(get_row_timer_group(cell_index->row), 0);
       timer_countdown_window_push(cell_index->row, 0);
       break;
     default:
       APP_LOG(APP_LOG_LEVEL_DEBUG, "Only support long click on timer groups");
       return;
   }
-  // Refresh window
-  // Todo: determine if these lines are necessary
-  layer_mark_dirty(menu_layer_get_layer(s_menu_layer));
-  menu_layer_reload_data(s_menu_layer);
 }
-
-#ifndef NDEBUG
-static void create_test_data()
-{
-  struct App_data* app_data = app_data_get();
-  struct List* timer_groups = app_data_get_timer_groups(app_data);
-
-  // Timer group 1
-  struct Timer_group* timer_group = timer_group_create();
-  list_add(timer_groups, timer_group);
-
-  struct Timer* timer = timer_create(app_data_get_next_timer_id(app_data));
-  timer_set_all(timer, 0, 45, 0);
-  timer_group_add_timer(timer_group, timer);
-
-  timer = timer_create(app_data_get_next_timer_id(app_data));
-  timer_set_all(timer, 0, 15, 0);
-  timer_group_add_timer(timer_group, timer);
-
-  struct Settings* settings = timer_group_get_settings(timer_group);
-  settings_set_repeat_style(settings, REPEAT_STYLE_GROUP);
-  settings_set_progress_style(settings, PROGRESS_STYLE_WAIT_FOR_USER);
-  settings_set_vibrate_style(settings, VIBRATE_STYLE_NUDGE);
-
-  // Timer group 2
-  timer_group = timer_group_create();
-  list_add(timer_groups, timer_group);
-
-  timer = timer_create(app_data_get_next_timer_id(app_data));
-  timer_set_all(timer, 0, 0, 5);
-  timer_group_add_timer(timer_group, timer);
-
-  timer = timer_create(app_data_get_next_timer_id(app_data));
-  timer_set_all(timer, 0, 0, 10);
-  timer_group_add_timer(timer_group, timer);
-
-  settings = timer_group_get_settings(timer_group);
-  settings_set_repeat_style(settings, REPEAT_STYLE_GROUP);
-  settings_set_progress_style(settings, PROGRESS_STYLE_AUTO);
-  settings_set_vibrate_style(settings, VIBRATE_STYLE_NUDGE);
-
-  // Timer group 3
-  timer_group = timer_group_create();
-  list_add(timer_groups, timer_group);
-
-  timer = timer_create(app_data_get_next_timer_id(app_data));
-  timer_set_all(timer, 0, 0, 20);
-  timer_group_add_timer(timer_group, timer);
-
-  settings = timer_group_get_settings(timer_group);
-  settings_set_repeat_style(settings, REPEAT_STYLE_GROUP);
-  settings_set_progress_style(settings, PROGRESS_STYLE_AUTO);
-  settings_set_vibrate_style(settings, VIBRATE_STYLE_NUDGE);
-
-  // Timer group 4
-  timer_group = timer_group_create();
-  list_add(timer_groups, timer_group);
-
-  timer = timer_create(app_data_get_next_timer_id(app_data));
-  timer_set_all(timer, 0, 0, 5);
-  timer_group_add_timer(timer_group, timer);
-
-  timer = timer_create(app_data_get_next_timer_id(app_data));
-  timer_set_all(timer, 0, 1, 0);
-  timer_group_add_timer(timer_group, timer);
-
-  settings = timer_group_get_settings(timer_group);
-  settings_set_repeat_style(settings, REPEAT_STYLE_GROUP);
-  settings_set_progress_style(settings, PROGRESS_STYLE_AUTO);
-  settings_set_vibrate_style(settings, VIBRATE_STYLE_NUDGE);
-}
-#endif /* NDEBUG */
@@ -1,5 +1,6 @@
 #include "persist_util.h"
 #include "assert.h"
+#include "energy.h"
 
 #include <pebble.h>
 
@@ -33,5 +34,19 @@ void persist_finish_load()
 void persist_finish_save()
 {
   s_max_persist_key = g_current_persist_key;
-  persist_write_int(MAX_PERSIST_KEY_KEY, s_max_persist_key);
+  persist_util_write_int(MAX_PERSIST_KEY_KEY, s_max_persist_key);
+}
+
+void persist_util_write_int(const uint32_t key, const int32_t value)
+{
+  energy_count(ENERGY_COUNTER_PERSIST_WRITE);
+  energy_add(ENERGY_COUNTER_PERSIST_BYTES, sizeof(value));
+  persist_write_int(key, value);
+}
+
+void persist_util_write_data(const uint32_t key, const void* data, const int size)
+{
+  energy_count(ENERGY_COUNTER_PERSIST_WRITE);
+  energy_add(ENERGY_COUNTER_PERSIST_BYTES, size);
+  persist_write_data(key, data, size);
 }
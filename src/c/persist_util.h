@@ -1,8 +1,10 @@
 #ifndef PERSIST_UTIL_H
 #define PERSIST_UTIL_H
 
+#include <pebble.h>
+
 #define PERSIST_VERSION_KEY 0
-#define PERSIST_VERSION 1
+#define PERSIST_VERSION 2
 
 extern int g_current_persist_key;
 
@@ -23,4 +25,11 @@ Should be called after app data is saved.
 */
 void persist_finish_save();
 
+/*
+Same as persist_write_int and persist_write_data, but counted in the energy
+counters. Should be used for all app data writes.
+*/
+void persist_util_write_int(const uint32_t key, const int32_t value);
+void persist_util_write_data(const uint32_t key, const void* data, const int size);
+
 #endif /*PERSIST_UTIL_H*/
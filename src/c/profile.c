@@ -0,0 +1,79 @@
+#include "profile.h"
+
+#ifndef NDEBUG
+
+#include "globals.h"
+
+#include <pebble.h>
+
+struct Profile_scope {
+  const char* name;
+  uint32_t count;
+  uint32_t total_ms;
+  uint32_t max_ms;
+};
+
+static struct Profile_scope s_scopes[PROFILE_MAX_SCOPES];
+static int s_num_scopes = 0;
+
+// Helpers
+// Slot of the scope with the name, added if it's new. INVALID_INDEX if the table is full.
+static int find_scope(const char* name);
+
+uint32_t profile_now_ms()
+{
+  time_t seconds;
+  uint16_t ms;
+  time_ms(&seconds, &ms);
+  return (uint32_t) seconds * MS_PER_SECOND + ms;
+}
+
+void profile_record(int* scope_index, const char* name, uint32_t elapsed_ms)
+{
+  if (*scope_index == INVALID_INDEX) {
+    *scope_index = find_scope(name);
+    if (*scope_index == INVALID_INDEX) {
+      return;
+    }
+  }
+  struct Profile_scope* scope = &s_scopes[*scope_index];
+  scope->count++;
+  scope->total_ms += elapsed_ms;
+  if (elapsed_ms > scope->max_ms) {
+    scope->max_ms = elapsed_ms;
+  }
+}
+
+void profile_log()
+{
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Profile: %d scopes, %d bytes free", s_num_scopes, (int) heap_bytes_free());
+  for (int i = 0; i < s_num_scopes; ++i) {
+    const struct Profile_scope* scope = &s_scopes[i];
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "%s: count %lu, total %lu ms, avg %lu ms, max %lu ms", scope->name,
+      (unsigned long) scope->count, (unsigned long) scope->total_ms,
+      (unsigned long) (scope->count ? scope->total_ms / scope->count : 0), (unsigned long) scope->max_ms);
+  }
+}
+
+// Helpers
+static int find_scope(const char* name)
+{
+  for (int i = 0; i < s_num_scopes; ++i) {
+    if (strcmp(s_scopes[i].name, name) == 0) {
+      return i;
+    }
+  }
+  if (s_num_scopes >= PROFILE_MAX_SCOPES) {
+    APP_LOG(APP_LOG_LEVEL_WARNING, "Profile table full, dropping scope %s", name);
+    return INVALID_INDEX;
+  }
+  s_scopes[s_num_scopes] = (struct Profile_scope) {
+    .name = name,
+    .count = 0,
+    .total_ms = 0,
+    .max_ms = 0
+  };
+  return s_num_scopes++;
+}
+
+#endif /* NDEBUG */
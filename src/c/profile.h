@@ -0,0 +1,44 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "globals.h"
+
+#include <pebble.h>
+
+/*
+Times named scopes in debug builds, to find out what callbacks cost on each
+platform. Wrap the code with PROFILE_BEGIN(name) and PROFILE_END(name) in the
+same block; the name must be a plain identifier. Each scope accumulates a
+count, total and max in milliseconds, which profile_log writes to the app
+log. Everything compiles out under NDEBUG.
+
+Times come from time_ms, so they only have millisecond resolution: a scope
+that usually takes less shows up as a low total over a high count.
+*/
+
+#ifndef NDEBUG
+
+// Most scopes tracked at a time; the rest are dropped
+#define PROFILE_MAX_SCOPES 16
+
+#define PROFILE_BEGIN(name) \
+  static int s_profile_scope_##name = INVALID_INDEX; \
+  const uint32_t profile_begin_##name = profile_now_ms()
+#define PROFILE_END(name) \
+  profile_record(&s_profile_scope_##name, #name, profile_now_ms() - profile_begin_##name)
+
+// Milliseconds on a clock that wraps, only meaningful as a difference
+uint32_t profile_now_ms();
+// Add a run of the scope. scope_index caches the scope's slot between calls.
+void profile_record(int* scope_index, const char* name, uint32_t elapsed_ms);
+// Write every scope to the app log
+void profile_log();
+
+#else
+
+#define PROFILE_BEGIN(name) ((void)0)
+#define PROFILE_END(name) ((void)0)
+
+#endif /* NDEBUG */
+
+#endif /*PROFILE_H*/
@@ -5,13 +5,24 @@
 #include "assert.h"
 #include "Timer_group.h"
 #include "draw_utility.h"
+#include "Model_events.h"
+#include "window_cache.h"
 
 #include <pebble.h>
 
+// What the menu shows, so its callbacks don't go through the app data
+struct View_model {
+  struct Settings* settings;  // Settings being edited
+  const char* title_texts[NUM_SETTINGS_FIELDS];
+  const char* subtitle_texts[NUM_SETTINGS_FIELDS];
+};
+
 static Window* s_settings_window;
 static MenuLayer* s_menu_layer;
 static int s_timer_group_index;
 static StatusBarLayer* s_status_bar_layer;
+static struct View_model s_view_model;
+static int s_model_events_handle;
 
 // WindowHandlers
 static void window_load_handler(Window* window);
@@ -25,6 +36,12 @@ static void menu_select_click_callback(MenuLayer* menu_layer, MenuIndex* cell_in
 
 // Helpers
 static struct Settings* get_settings(const struct App_data* app_data, int timer_group_index);
+static const char* get_settings_field_value_text(const struct Settings* settings, enum Settings_field settings_field);
+static void model_event_handler(const struct Model_event_data* event_data, void* context);
+static void update_view_model();
+static void create_layers(Window* window);
+// Destroy the window and its layers
+static void destroy_window(Window* window);
 static enum Settings_field get_settings_field(int settings_field_index);
 static enum Repeat_style get_next_repeat_style(enum Repeat_style repeat_style);
 static enum Progress_style get_next_progress_style(enum Progress_style progress_style);
@@ -32,22 +49,44 @@ static enum Vibrate_style get_next_vibrate_style(enum Vibrate_style vibrate_styl
 
 void settings_window_push(int timer_group)
 {
-  s_settings_window = window_create();
+  if (!s_settings_window) {
+    s_settings_window = window_create();
 
-  assert(s_settings_window);
+    assert(s_settings_window);
 
-  s_timer_group_index = timer_group;
+    window_set_window_handlers(s_settings_window, (WindowHandlers) {
+      .load = window_load_handler,
+      .unload = window_unload_handler
+    });
+  }
+  window_cache_take(s_settings_window);
 
-  window_set_window_handlers(s_settings_window, (WindowHandlers) {
-    .load = window_load_handler,
-    .unload = window_unload_handler
-  });
+  s_timer_group_index = timer_group;
 
   window_stack_push(s_settings_window, false);
 }
 
 // WindowHandlers
 static void window_load_handler(Window* window)
+{
+  bool cached = s_menu_layer != NULL;
+  if (!cached) {
+    create_layers(window);
+  }
+  menu_layer_set_click_config_onto_window(s_menu_layer, window);
+
+  s_view_model.settings = get_settings(app_data_get(), s_timer_group_index);
+  update_view_model();
+  s_model_events_handle = model_events_subscribe(model_event_handler, NULL);
+
+  if (cached) {
+    // Show the new settings from the top
+    menu_layer_reload_data(s_menu_layer);
+    menu_layer_set_selected_index(s_menu_layer, (MenuIndex) {0, 0}, MenuRowAlignTop, false);
+  }
+}
+
+static void create_layers(Window* window)
 {
   Layer* window_layer = window_get_root_layer(window);
 
@@ -69,12 +108,19 @@ static void window_load_handler(Window* window)
     .select_click = menu_select_click_callback
   });
 
-  menu_layer_set_click_config_onto_window(s_menu_layer, window);
-
   layer_add_child(window_layer, menu_layer_get_layer(s_menu_layer));
 }
 
 static void window_unload_handler(Window* window)
+{
+  model_events_unsubscribe(s_model_events_handle);
+  s_model_events_handle = INVALID_INDEX;
+  s_view_model.settings = NULL;
+
+  window_cache_release(s_settings_window, destroy_window);
+}
+
+static void destroy_window(Window* window)
 {
   menu_layer_destroy(s_menu_layer);
   s_menu_layer = NULL;
@@ -99,29 +145,47 @@ static uint16_t menu_get_num_rows_callback(MenuLayer* menu_layer, uint16_t secti
 
 static void menu_draw_row_callback(GContext* ctx, const Layer* cell_layer, MenuIndex* cell_index, void* data)
 {
-  struct Settings* settings = get_settings(app_data_get(), s_timer_group_index);
-
-  enum Settings_field settings_field = get_settings_field(cell_index->row);
+  if (cell_index->row >= NUM_SETTINGS_FIELDS) {
+    APP_LOG(APP_LOG_LEVEL_ERROR, "Invalid row index: %d", cell_index->row);
+    return;
+  }
+  menu_cell_basic_draw(ctx, cell_layer, s_view_model.title_texts[cell_index->row],
+    s_view_model.subtitle_texts[cell_index->row], NULL);
+}
 
-  const char* small_text;
+static const char* get_settings_field_value_text(const struct Settings* settings, enum Settings_field settings_field)
+{
   switch (settings_field) {
     case SETTINGS_FIELD_REPEAT_STYLE:
-      small_text = settings_get_repeat_style_text(settings_get_repeat_style(settings));
-      break;
+      return settings_get_repeat_style_text(settings_get_repeat_style(settings));
     case SETTINGS_FIELD_PROGRESS_STYLE:
-      small_text = settings_get_progress_style_text(settings_get_progress_style(settings));
-      break;
+      return settings_get_progress_style_text(settings_get_progress_style(settings));
     case SETTINGS_FIELD_VIBRATE_STYLE:
-      small_text = settings_get_vibrate_style_text(settings_get_vibrate_style(settings));
-      break;
+      return settings_get_vibrate_style_text(settings_get_vibrate_style(settings));
     case SETTINGS_FIELD_INVALID: // intentional fall through
     default:
-      small_text = "";
-      break;
+      return "";
+  }
+}
+
+static void model_event_handler(const struct Model_event_data* event_data, void* context)
+{
+  if (event_data->event != MODEL_EVENT_SETTINGS_CHANGED || event_data->subject != s_view_model.settings) {
+    return;
   }
+  update_view_model();
+  // Only the texts changed
+  layer_mark_dirty(menu_layer_get_layer(s_menu_layer));
+}
 
-  menu_cell_basic_draw(ctx, cell_layer,
-    settings_get_settings_field_text(settings_field), small_text, NULL);
+static void update_view_model()
+{
+  assert(s_view_model.settings);
+  for (int i = 0; i < NUM_SETTINGS_FIELDS; ++i) {
+    enum Settings_field settings_field = get_settings_field(i);
+    s_view_model.title_texts[i] = settings_get_settings_field_text(settings_field);
+    s_view_model.subtitle_texts[i] = get_settings_field_value_text(s_view_model.settings, settings_field);
+  }
 }
 
 static struct Settings* get_settings(const struct App_data* app_data, int timer_group_index)
@@ -149,7 +213,7 @@ static enum Settings_field get_settings_field(int settings_field_index)
 
 static void menu_select_click_callback(MenuLayer* menu_layer, MenuIndex* cell_index, void* data)
 {
-  struct Settings* settings = get_settings(app_data_get(), s_timer_group_index);
+  struct Settings* settings = s_view_model.settings;
   enum Settings_field settings_field = get_settings_field(cell_index->row);
 
   switch (settings_field) {
@@ -167,7 +231,6 @@ static void menu_select_click_callback(MenuLayer* menu_layer, MenuIndex* cell_in
       APP_LOG(APP_LOG_LEVEL_ERROR, "Invalid settings field: %d", settings_field);
       break;
   }
-  menu_layer_reload_data(s_menu_layer);
 }
 
 static enum Repeat_style get_next_repeat_style(enum Repeat_style repeat_style)
@@ -208,6 +271,10 @@ static enum Vibrate_style get_next_vibrate_style(enum Vibrate_style vibrate_styl
     case VIBRATE_STYLE_NONE:
       return VIBRATE_STYLE_NUDGE;
     case VIBRATE_STYLE_NUDGE:
+      return VIBRATE_STYLE_NUDGE_BACKOFF;
+    case VIBRATE_STYLE_NUDGE_BACKOFF:
+      return VIBRATE_STYLE_NUDGE_LIMITED;
+    case VIBRATE_STYLE_NUDGE_LIMITED:
       return VIBRATE_STYLE_CONTINUOUS;
     case VIBRATE_STYLE_CONTINUOUS:
       return VIBRATE_STYLE_NONE;
@@ -0,0 +1,191 @@
+#include "test_data.h"
+
+#ifndef NDEBUG
+
+#include "App_data.h"
+#include "Timer_group.h"
+#include "Timer.h"
+#include "Settings.h"
+#include "Scheduler.h"
+#include "List.h"
+#include "profile.h"
+#include "globals.h"
+#include "assert.h"
+#include "Utility.h"
+
+#include <pebble.h>
+
+// Time between stress rounds
+#define STRESS_ROUND_MS 500
+// Groups stress mode keeps before it deletes the oldest
+#define STRESS_MAX_GROUPS 4
+#define STRESS_SEED 48271
+
+struct Stress_state {
+  AppTimer* app_timer_handle;
+  struct Data_generator generator;
+  struct Timer_group* timer_groups[STRESS_MAX_GROUPS + 1]; // Oldest first
+  int num_timer_groups;
+  int round;
+  int min_heap_free;
+};
+static struct Stress_state s_stress;
+
+// Helpers
+static struct Timer_group* add_generated_group(struct Data_generator* generator);
+static void stress_round_handler(void* data);
+static void stress_delete_oldest_group();
+static int count_timers();
+
+void test_data_default_params(struct Data_generator_params* params, uint32_t seed)
+{
+  assert(params);
+  *params = (struct Data_generator_params) {
+    .num_groups = TEST_DATA_NUM_GROUPS,
+    .num_timers = TEST_DATA_NUM_TIMERS,
+    .min_length = TEST_DATA_MIN_LENGTH,
+    .max_length = TEST_DATA_MAX_LENGTH,
+    .running_percent = TEST_DATA_RUNNING_PERCENT,
+    .seed = seed
+  };
+}
+
+void test_data_generate(const struct Data_generator_params* params)
+{
+  assert(params);
+  struct Data_generator generator;
+  data_generator_init(&generator, params);
+  uint32_t begin_ms = profile_now_ms();
+  for (int i = 0; i < params->num_groups; ++i) {
+    add_generated_group(&generator);
+  }
+  APP_LOG(APP_LOG_LEVEL_INFO, "Generated %d groups of %d timers with seed %u in %u ms, %d bytes free",
+    params->num_groups, params->num_timers, (unsigned int) params->seed,
+    (unsigned int) (profile_now_ms() - begin_ms), (int) heap_bytes_free());
+}
+
+void test_data_stress_start()
+{
+  if (test_data_stress_running()) {
+    return;
+  }
+  struct Data_generator_params params;
+  test_data_default_params(&params, STRESS_SEED);
+  params.running_percent = 0;
+  data_generator_init(&s_stress.generator, &params);
+  s_stress.num_timer_groups = 0;
+  s_stress.round = 0;
+  s_stress.min_heap_free = heap_bytes_free();
+  APP_LOG(APP_LOG_LEVEL_INFO, "Stress test started, %d bytes free", s_stress.min_heap_free);
+  s_stress.app_timer_handle = app_timer_register(STRESS_ROUND_MS, stress_round_handler, NULL);
+}
+
+void test_data_stress_stop()
+{
+  if (!test_data_stress_running()) {
+    return;
+  }
+  app_timer_cancel(s_stress.app_timer_handle);
+  s_stress.app_timer_handle = NULL;
+  while (s_stress.num_timer_groups > 0) {
+    stress_delete_oldest_group();
+  }
+  APP_LOG(APP_LOG_LEVEL_INFO, "Stress test stopped after %d rounds, %d bytes free, at least %d",
+    s_stress.round, (int) heap_bytes_free(), s_stress.min_heap_free);
+}
+
+int test_data_stress_running()
+{
+  return s_stress.app_timer_handle != NULL;
+}
+
+/*
+Helpers
+*/
+static struct Timer_group* add_generated_group(struct Data_generator* generator)
+{
+  struct App_data* app_data = app_data_get();
+  struct Generated_group generated_group;
+  data_generator_next_group(generator, &generated_group);
+
+  struct Timer_group* timer_group = timer_group_create();
+  struct Settings* settings = timer_group_get_settings(timer_group);
+  settings_set_repeat_style(settings, generated_group.repeat_style);
+  settings_set_progress_style(settings, generated_group.progress_style);
+  settings_set_vibrate_style(settings, generated_group.vibrate_style);
+  app_data_add_timer_group(app_data, timer_group);
+
+  for (int i = 0; i < generator->params.num_timers; ++i) {
+    int length = data_generator_next_length(generator);
+    struct Timer* timer = timer_create(app_data_get_next_timer_id(app_data));
+    timer_set_all(timer, length / SECONDS_PER_HOUR, length % SECONDS_PER_HOUR / SECONDS_PER_MINUTE,
+      length % SECONDS_PER_MINUTE);
+    timer_group_add_timer(timer_group, timer);
+  }
+  if (generated_group.running_timer_index >= 0) {
+    scheduler_group_start(timer_group, generated_group.running_timer_index);
+  }
+  return timer_group;
+}
+
+static void stress_round_handler(void* data)
+{
+  uint32_t begin_ms = profile_now_ms();
+  struct Data_generator* generator = &s_stress.generator;
+
+  // Create
+  struct Timer_group* timer_group = add_generated_group(generator);
+  s_stress.timer_groups[s_stress.num_timer_groups++] = timer_group;
+
+  // Edit and start
+  struct Timer* timer = timer_group_get_timer(timer_group,
+    data_generator_next_int(generator, timer_group_size(timer_group)));
+  timer_set_field(timer, TIMER_FIELD_MINUTES, data_generator_next_int(generator, 60));
+  scheduler_timer_start(timer);
+
+  // Delete
+  if (s_stress.num_timer_groups > STRESS_MAX_GROUPS) {
+    stress_delete_oldest_group();
+  }
+
+  ++s_stress.round;
+  int heap_free = heap_bytes_free();
+  s_stress.min_heap_free = min(s_stress.min_heap_free, heap_free);
+  APP_LOG(APP_LOG_LEVEL_INFO, "STRESS round %d: %d groups, %d timers, %d bytes free, at least %d, %u ms",
+    s_stress.round, list_size(app_data_get_timer_groups(app_data_get())), count_timers(),
+    heap_free, s_stress.min_heap_free, (unsigned int) (profile_now_ms() - begin_ms));
+
+  s_stress.app_timer_handle = app_timer_register(STRESS_ROUND_MS, stress_round_handler, NULL);
+}
+
+static void stress_delete_oldest_group()
+{
+  assert(s_stress.num_timer_groups > 0);
+  struct App_data* app_data = app_data_get();
+  struct Timer_group* timer_group = s_stress.timer_groups[0];
+  struct List* timer_groups = app_data_get_timer_groups(app_data);
+  for (int i = 0; i < list_size(timer_groups); ++i) {
+    if (list_get(timer_groups, i) == timer_group) {
+      timer_group_cancel_wakeups(timer_group);
+      app_data_remove_timer_group(app_data, i);
+      timer_group_destroy(timer_group);
+      break;
+    }
+  }
+  --s_stress.num_timer_groups;
+  for (int i = 0; i < s_stress.num_timer_groups; ++i) {
+    s_stress.timer_groups[i] = s_stress.timer_groups[i + 1];
+  }
+}
+
+static int count_timers()
+{
+  struct List* timer_groups = app_data_get_timer_groups(app_data_get());
+  int num_timers = 0;
+  for (int i = 0; i < list_size(timer_groups); ++i) {
+    num_timers += timer_group_size(list_get(timer_groups, i));
+  }
+  return num_timers;
+}
+
+#endif /* NDEBUG */
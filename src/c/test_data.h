@@ -0,0 +1,39 @@
+#ifndef TEST_DATA_H
+#define TEST_DATA_H
+
+#ifndef NDEBUG
+
+#include "Data_generator.h"
+
+/*
+Debug tools that fill the app data with generated timer groups (see
+Data_generator.h), to try the app with as much data as a heavy user has.
+*/
+
+// Defaults of the "Generate data" debug row
+#define TEST_DATA_NUM_GROUPS 8
+#define TEST_DATA_NUM_TIMERS 4
+#define TEST_DATA_MIN_LENGTH 5
+#define TEST_DATA_MAX_LENGTH (2 * 60 * 60)
+#define TEST_DATA_RUNNING_PERCENT 25
+
+// Fill params with the defaults above and the given seed
+void test_data_default_params(struct Data_generator_params* params, uint32_t seed);
+// Add params->num_groups generated groups to the app data and start their running timers
+void test_data_generate(const struct Data_generator_params* params);
+
+/*
+Stress mode creates a group every round, edits and starts one of its timers
+and deletes the oldest group it created once it has more than a few, logging
+the free heap and the time each round took. Leave the main menu showing while
+it runs: the groups it deletes must not be open in another window.
+*/
+void test_data_stress_start();
+// Stop the rounds and delete the groups stress mode still owns
+void test_data_stress_stop();
+// Return non-zero if stress mode is running
+int test_data_stress_running();
+
+#endif /* NDEBUG */
+
+#endif /*TEST_DATA_H*/
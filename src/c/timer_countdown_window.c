@@ -9,31 +9,56 @@
 #include "assert.h"
 #include "draw_utility.h"
 #include "Utility.h"
-#include "Wakeup_manager.h"
-#include "wakeup_util.h"
+#include "Scheduler.h"
+#include "window_cache.h"
+#include "profile.h"
+#include "energy.h"
 
 #include <pebble.h>
 
-static Window* s_timer_countdown_window;
-static TextLayer* s_timer_countdown_text_layer;
-static TextLayer* s_timer_length_text_layer;
-static int s_timer_group_index;
-static int s_timer_index;
-static AppTimer* s_app_timer_handle;
-static AppTimer* s_app_timer_vibrate_handle;
-static StatusBarLayer* s_status_bar_layer;
-
-static char s_timer_countdown_text_buffer[TIMER_TEXT_LENGTH];
-static char s_timer_length_text_buffer[TIMER_TEXT_LENGTH];
+// One countdown window. Several can be on the window stack at once, one per
+// timer group.
+struct Countdown_window {
+  Window* window;
+  struct Countdown_layer* countdown_layer;
+  TextLayer* length_text_layer;
+  struct Progress_layer* progress_layer;
+  StatusBarLayer* status_bar_layer;
+  int timer_id;         // Timer shown; follows the group when it progresses
+  bool shown;           // On the window stack rather than cached
+  char countdown_text_buffer[TIMER_TEXT_LENGTH];
+  char length_text_buffer[TIMER_TEXT_LENGTH];
+};
+
+// Every countdown window, shown or cached. They share one scheduler subscription.
+static struct List* s_countdown_windows = NULL;
+static int s_scheduler_handle = INVALID_INDEX;
+// Refreshes the countdown window on top of the window stack. Hidden windows
+// catch up when they appear.
+static AppTimer* s_tick_handle = NULL;
 
 // Window Handlers
 static void window_load_handler(Window* window);
 static void window_appear_handler(Window* window);
 static void window_unload_handler(Window* window);
+static void create_layers(struct Countdown_window* countdown_window);
+// Destroy the window, its layers and its context
+static void destroy_window(Window* window);
+
+// Countdown windows
+static struct Countdown_window* countdown_window_create();
+// Return the shown window of the group, or null if there is none
+static struct Countdown_window* find_shown(int timer_group_index);
+// Return a cached window, or null if there is none
+static struct Countdown_window* find_cached();
+// Return the window on top of the window stack if it's a countdown window
+static struct Countdown_window* get_top();
+static struct Timer* get_timer(const struct Countdown_window* countdown_window);
+static int get_timer_group_index(const struct Countdown_window* countdown_window);
 
 // Timer display
-static void update_timer_countdown_text_layer(struct Timer* timer);
-static void update_timer_length_text_layer(struct Timer* timer);
+static void update_timer_countdown_text_layer(struct Countdown_window* countdown_window, struct Timer* timer);
+static void update_timer_length_text_layer(struct Countdown_window* countdown_window, struct Timer* timer);
 
 // Click handlers
 static void click_config_provider(void* context);
@@ -41,55 +66,86 @@ static void click_handler_up(ClickRecognizerRef recognizer, void* context);
 static void click_handler_select(ClickRecognizerRef recognizer, void* context);
 static void click_handler_down(ClickRecognizerRef recognizer, void* context);
 
-// Timer handler
-static void start_app_timer(int delay, AppTimerCallback app_timer_callback, void* data);
-static void cancel_app_timers();
-static void timer_handler(void* data);
-static void vibrate_timer_handler(void* data);
+// Tick
+// Refresh the top countdown window after delay, then every second while its timer runs
+static void start_tick(int delay);
+static void stop_tick();
+static void tick_handler(void* data);
 
-// Helpers
-// Return true if the new timer should start after this is called,
-// false otherwise
-static bool update_current_timer(struct App_data* app_data);
+// Scheduler events
+static void scheduler_event_handler(const struct Scheduler_event_data* event_data, void* context);
+static void handle_scheduler_event(struct Countdown_window* countdown_window,
+  const struct Scheduler_event_data* event_data);
 
 void timer_countdown_window_push_id(int timer_id)
 {
-  int timer_group_index = app_data_get_timer_group_index_by_timer_id(app_data_get(), timer_id);
-  int timer_index = timer_group_get_timer_index(app_data_get_timer_group(app_data_get(), timer_group_index), timer_id);
+  struct App_data* app_data = app_data_get();
+  int timer_group_index = app_data_get_timer_group_index_by_timer_id(app_data, timer_id);
+  struct Timer_group* timer_group = app_data_get_timer_group(app_data, timer_group_index);
+  if (!timer_group) {
+    APP_LOG(APP_LOG_LEVEL_WARNING, "No timer with id: %d", timer_id);
+    return;
+  }
+  int timer_index = timer_group_get_running_timer_index(timer_group);
+  if (timer_index < 0) {
+    timer_index = timer_group_get_timer_index(timer_group, timer_id);
+  }
   timer_countdown_window_push(timer_group_index, timer_index);
 }
 
 void timer_countdown_window_push(int timer_group_index, int timer_index)
 {
-  if (s_timer_countdown_window) {
+  struct Timer* timer = app_data_get_timer(app_data_get(), timer_group_index, timer_index);
+  if (!timer) {
+    APP_LOG(APP_LOG_LEVEL_WARNING, "No timer at %d in group %d", timer_index, timer_group_index);
     return;
   }
-  s_timer_countdown_window = window_create();
-  window_set_window_handlers(s_timer_countdown_window, (WindowHandlers) {
-    .load = window_load_handler,
-    .appear = window_appear_handler,
-    .unload = window_unload_handler
-  });
-  s_timer_group_index = timer_group_index;
-  s_timer_index = timer_index;
-  window_stack_push(s_timer_countdown_window, false);
+  struct Countdown_window* countdown_window = find_shown(timer_group_index);
+  if (countdown_window) {
+    if (countdown_window == get_top()) {
+      return;
+    }
+    // Bring the group's window to the front rather than stack a second one
+    window_stack_remove(countdown_window->window, false);
+  }
+  countdown_window = find_cached();
+  if (!countdown_window) {
+    countdown_window = countdown_window_create();
+  }
+  window_cache_take(countdown_window->window);
+  countdown_window->timer_id = timer_get_id(timer);
+  window_stack_push(countdown_window->window, false);
 }
 
 static void window_load_handler(Window* window)
 {
-  Layer* window_layer = window_get_root_layer(window);
+  struct Countdown_window* countdown_window = window_get_user_data(window);
+  assert(countdown_window);
+  PROFILE_BEGIN(countdown_window_load);
+  countdown_window->shown = true;
+
+  window_set_click_config_provider_with_context(window, click_config_provider, countdown_window);
 
-  window_set_click_config_provider(window, click_config_provider);
+  // Setup other variables
+  countdown_window->countdown_text_buffer[0] = '\0';
+  countdown_window->length_text_buffer[0] = '\0';
 
-  // Setup other static variables
-  s_timer_countdown_text_buffer[0] = '\0';
-  s_timer_length_text_buffer[0] = '\0';
+  if (!countdown_window->countdown_layer) {
+    create_layers(countdown_window);
+  }
+  struct Timer* timer = get_timer(countdown_window);
+  update_timer_countdown_text_layer(countdown_window, timer);
+  update_timer_length_text_layer(countdown_window, timer);
+  PROFILE_END(countdown_window_load);
+}
 
-  struct Timer* timer = app_data_get_timer(app_data_get(), s_timer_group_index, s_timer_index);
+static void create_layers(struct Countdown_window* countdown_window)
+{
+  Layer* window_layer = window_get_root_layer(countdown_window->window);
 
   // Status bar layer
-  s_status_bar_layer = status_bar_create();
-  layer_add_child(window_layer, status_bar_layer_get_layer(s_status_bar_layer));
+  countdown_window->status_bar_layer = status_bar_create();
+  layer_add_child(window_layer, status_bar_layer_get_layer(countdown_window->status_bar_layer));
 
   // Countdown layer
   GRect window_bounds = layer_get_bounds(window_layer);
@@ -97,57 +153,151 @@ static void window_load_handler(Window* window)
   GRect timer_bounds = window_bounds;
   timer_bounds.size.h = TIMER_TEXT_HEIGHT;
   grect_align(&timer_bounds, &window_bounds, GAlignLeft, false);
-  s_timer_countdown_text_layer = text_layer_create(timer_bounds);
-  assert(s_timer_countdown_text_layer);
-  text_layer_set_text_color(s_timer_countdown_text_layer, GColorBlack);
-  text_layer_set_background_color(s_timer_countdown_text_layer, GColorWhite);
-  text_layer_set_text_alignment(s_timer_countdown_text_layer, GTextAlignmentCenter);
-  text_layer_set_font(s_timer_countdown_text_layer, fonts_get_system_font(FONT_KEY_LECO_32_BOLD_NUMBERS));
-  layer_add_child(window_layer, text_layer_get_layer(s_timer_countdown_text_layer));
-  update_timer_countdown_text_layer(timer);
+  countdown_window->countdown_layer = countdown_layer_create(timer_bounds,
+    fonts_get_system_font(FONT_KEY_LECO_32_BOLD_NUMBERS));
+  assert(countdown_window->countdown_layer);
+  layer_add_child(window_layer, countdown_layer_get_layer(countdown_window->countdown_layer));
 
   // Setup timer length layer
   GRect timer_length_bounds = timer_bounds;
   timer_length_bounds.size.h = TIMER_TEXT_HEIGHT_SM;
   grect_align(&timer_length_bounds, &timer_bounds, GAlignBottom, false);
-  s_timer_length_text_layer = text_layer_create(timer_length_bounds);
-  assert(s_timer_length_text_layer);
-  text_layer_set_text_color(s_timer_length_text_layer, GColorBlack);
-  text_layer_set_background_color(s_timer_length_text_layer, GColorWhite);
-  text_layer_set_text_alignment(s_timer_length_text_layer, GTextAlignmentCenter);
-  text_layer_set_font(s_timer_length_text_layer, fonts_get_system_font(FONT_KEY_LECO_20_BOLD_NUMBERS));
-  layer_add_child(window_layer, text_layer_get_layer(s_timer_length_text_layer));
-  update_timer_length_text_layer(timer);
+  TextLayer* length_text_layer = text_layer_create(timer_length_bounds);
+  assert(length_text_layer);
+  text_layer_set_text_color(length_text_layer, GColorBlack);
+  text_layer_set_background_color(length_text_layer, GColorWhite);
+  text_layer_set_text_alignment(length_text_layer, GTextAlignmentCenter);
+  text_layer_set_font(length_text_layer, fonts_get_system_font(FONT_KEY_LECO_20_BOLD_NUMBERS));
+  layer_add_child(window_layer, text_layer_get_layer(length_text_layer));
+  countdown_window->length_text_layer = length_text_layer;
+
+  // Progress layer, a ring around the edge or a bar under the timer
+#ifdef PBL_ROUND
+  GRect progress_bounds = layer_get_bounds(window_layer);
+#else
+  GRect progress_bounds = GRect(timer_bounds.origin.x + PROGRESS_BAR_INSET,
+    timer_bounds.origin.y + timer_bounds.size.h, timer_bounds.size.w - 2 * PROGRESS_BAR_INSET, PROGRESS_BAR_SPACE);
+#endif
+  countdown_window->progress_layer = progress_layer_create(progress_bounds);
+  assert(countdown_window->progress_layer);
+  layer_add_child(window_layer, progress_layer_get_layer(countdown_window->progress_layer));
 }
 
 static void window_appear_handler(Window* window)
 {
-  struct App_data* app_data = app_data_get();
-  struct Timer* timer = app_data_get_timer(app_data, s_timer_group_index, s_timer_index);
+  struct Countdown_window* countdown_window = window_get_user_data(window);
+  struct Timer* timer = get_timer(countdown_window);
   if (!timer) {
-    window_stack_pop(false);
+    window_stack_remove(window, false);
     return;
   }
-  update_timer_countdown_text_layer(timer);
-  update_timer_length_text_layer(timer);
-  start_app_timer(0, timer_handler, app_data);
+  update_timer_countdown_text_layer(countdown_window, timer);
+  update_timer_length_text_layer(countdown_window, timer);
+  start_tick(0);
 }
 
 static void window_unload_handler(Window* window)
 {
-  cancel_app_timers();
+  struct Countdown_window* countdown_window = window_get_user_data(window);
+  countdown_window->shown = false;
 
-  text_layer_destroy(s_timer_length_text_layer);
-  s_timer_length_text_layer = NULL;
+  window_cache_release(window, destroy_window);
+}
 
-  text_layer_destroy(s_timer_countdown_text_layer);
-  s_timer_countdown_text_layer = NULL;
+static void destroy_window(Window* window)
+{
+  struct Countdown_window* countdown_window = window_get_user_data(window);
+
+  text_layer_destroy(countdown_window->length_text_layer);
+  countdown_window->length_text_layer = NULL;
+
+  countdown_layer_destroy(countdown_window->countdown_layer);
+  countdown_window->countdown_layer = NULL;
+
+  progress_layer_destroy(countdown_window->progress_layer);
+  countdown_window->progress_layer = NULL;
+
+  status_bar_layer_destroy(countdown_window->status_bar_layer);
+  countdown_window->status_bar_layer = NULL;
 
-  status_bar_layer_destroy(s_status_bar_layer);
-  s_status_bar_layer = NULL;
+  window_destroy(countdown_window->window);
+  countdown_window->window = NULL;
 
-  window_destroy(s_timer_countdown_window);
-  s_timer_countdown_window = NULL;
+  list_remove_ptr(s_countdown_windows, countdown_window);
+  free(countdown_window);
+  if (list_empty(s_countdown_windows)) {
+    list_destroy(s_countdown_windows);
+    s_countdown_windows = NULL;
+    scheduler_unsubscribe(s_scheduler_handle);
+    s_scheduler_handle = INVALID_INDEX;
+  }
+}
+
+// Countdown windows
+static struct Countdown_window* countdown_window_create()
+{
+  struct Countdown_window* countdown_window = safe_alloc(sizeof(struct Countdown_window));
+  *countdown_window = (struct Countdown_window) {
+    .timer_id = INVALID_INDEX
+  };
+  countdown_window->window = window_create();
+  assert(countdown_window->window);
+  window_set_user_data(countdown_window->window, countdown_window);
+  window_set_window_handlers(countdown_window->window, (WindowHandlers) {
+    .load = window_load_handler,
+    .appear = window_appear_handler,
+    .unload = window_unload_handler
+  });
+  if (!s_countdown_windows) {
+    s_countdown_windows = list_create();
+    s_scheduler_handle = scheduler_subscribe(scheduler_event_handler, NULL);
+  }
+  list_add(s_countdown_windows, countdown_window);
+  return countdown_window;
+}
+
+static struct Countdown_window* find_shown(int timer_group_index)
+{
+  for (int i = 0; s_countdown_windows && i < list_size(s_countdown_windows); ++i) {
+    struct Countdown_window* countdown_window = list_get(s_countdown_windows, i);
+    if (countdown_window->shown && get_timer_group_index(countdown_window) == timer_group_index) {
+      return countdown_window;
+    }
+  }
+  return NULL;
+}
+
+static struct Countdown_window* find_cached()
+{
+  for (int i = 0; s_countdown_windows && i < list_size(s_countdown_windows); ++i) {
+    struct Countdown_window* countdown_window = list_get(s_countdown_windows, i);
+    if (!countdown_window->shown) {
+      return countdown_window;
+    }
+  }
+  return NULL;
+}
+
+static struct Countdown_window* get_top()
+{
+  Window* top_window = window_stack_get_top_window();
+  for (int i = 0; top_window && s_countdown_windows && i < list_size(s_countdown_windows); ++i) {
+    struct Countdown_window* countdown_window = list_get(s_countdown_windows, i);
+    if (countdown_window->window == top_window) {
+      return countdown_window;
+    }
+  }
+  return NULL;
+}
+
+static struct Timer* get_timer(const struct Countdown_window* countdown_window)
+{
+  return app_data_get_timer_by_id(app_data_get(), countdown_window->timer_id);
+}
+
+static int get_timer_group_index(const struct Countdown_window* countdown_window)
+{
+  return app_data_get_timer_group_index_by_timer_id(app_data_get(), countdown_window->timer_id);
 }
 
 // Click handlers
@@ -160,179 +310,139 @@ static void click_config_provider(void* context)
 
 static void click_handler_up(ClickRecognizerRef recognizer, void* context)
 {
-  struct Timer* timer = app_data_get_timer(app_data_get(), s_timer_group_index, s_timer_index);
-  timer_reset(timer);
-  wakeup_manager_cancel(app_data_get_wakeup_manager(app_data_get()), timer);
-  cancel_app_timers();
-  update_timer_countdown_text_layer(timer);
+  struct Countdown_window* countdown_window = context;
+  struct Timer* timer = get_timer(countdown_window);
+  scheduler_timer_reset(timer);
+  stop_tick();
+  update_timer_countdown_text_layer(countdown_window, timer);
 }
 
 static void click_handler_select(ClickRecognizerRef recognizer, void* context)
 {
-  struct App_data* app_data = app_data_get();
-  struct Timer* timer = app_data_get_timer(app_data, s_timer_group_index, s_timer_index);
-  timer_update(timer);
-  if (timer_is_elapsed(timer)) {
-    cancel_app_timers();
-    timer_reset(timer);
-    wakeup_manager_cancel(app_data_get_wakeup_manager(app_data_get()), timer);
-    if (!update_current_timer(app_data)) {
-      update_timer_countdown_text_layer(timer);
-      return;
-    }
-    timer = app_data_get_timer(app_data, s_timer_group_index, s_timer_index);
-    timer_reset(timer);
-    timer_start(timer);
-    wakeup_manager_schedule(app_data_get_wakeup_manager(app_data_get()), timer);
-    update_timer_countdown_text_layer(timer);
-    update_timer_length_text_layer(timer);
-    start_app_timer(0, timer_handler, app_data);
-    return;
-  }
+  struct Countdown_window* countdown_window = context;
+  // Progress moves the window on to the next timer through the scheduler event
+  struct Timer* timer = scheduler_timer_select(get_timer(countdown_window));
+  update_timer_countdown_text_layer(countdown_window, timer);
   if (timer_is_running(timer)) {
-    timer_pause(timer);
-    wakeup_manager_cancel(app_data_get_wakeup_manager(app_data_get()), timer);
-    cancel_app_timers();
+    start_tick(0);
   } else {
-    timer_start(timer);
-    wakeup_manager_schedule(app_data_get_wakeup_manager(app_data_get()), timer);
-    update_timer_countdown_text_layer(timer);
-    update_timer_length_text_layer(timer);
-    start_app_timer(0, timer_handler, app_data);
+    stop_tick();
   }
 }
 
 static void click_handler_down(ClickRecognizerRef recognizer, void* context)
 {
-  struct Timer* timer = app_data_get_timer(app_data_get(), s_timer_group_index, s_timer_index);
-  timer_reset(timer);
-  wakeup_manager_cancel(app_data_get_wakeup_manager(app_data_get()), timer);
-  cancel_app_timers();
-  timer_edit_window_push(s_timer_group_index, s_timer_index);
+  struct Countdown_window* countdown_window = context;
+  struct Timer* timer = get_timer(countdown_window);
+  scheduler_timer_reset(timer);
+  stop_tick();
+  int timer_group_index = get_timer_group_index(countdown_window);
+  timer_edit_window_push(timer_group_index, timer_group_get_timer_index(
+    app_data_get_timer_group(app_data_get(), timer_group_index), countdown_window->timer_id));
 }
 
-static void start_app_timer(int delay, AppTimerCallback app_timer_callback, void* data)
+// Tick
+static void start_tick(int delay)
 {
-  s_app_timer_handle = app_timer_register(delay, app_timer_callback, data);
+  stop_tick();
+  s_tick_handle = app_timer_register(delay, tick_handler, NULL);
 }
 
-static void cancel_app_timers()
+static void stop_tick()
 {
-  if (s_app_timer_handle) {
-    app_timer_cancel(s_app_timer_handle);
-    s_app_timer_handle = NULL;
-  }
-  if (s_app_timer_vibrate_handle) {
-    app_timer_cancel(s_app_timer_vibrate_handle);
-    s_app_timer_vibrate_handle = NULL;
+  if (s_tick_handle) {
+    app_timer_cancel(s_tick_handle);
+    s_tick_handle = NULL;
   }
 }
 
-static void timer_handler(void* data)
+// Only refreshes the display; the scheduler handles the timer elapsing
+static void tick_handler(void* data)
 {
-  s_app_timer_handle = NULL;
-  struct App_data* app_data = app_data_get();
-  struct Timer* timer = app_data_get_timer(app_data, s_timer_group_index, s_timer_index);
-  update_timer_countdown_text_layer(timer);
-  if (!timer_is_running(timer)) {
+  energy_count(ENERGY_COUNTER_APP_TIMER);
+  s_tick_handle = NULL;
+  struct Countdown_window* countdown_window = get_top();
+  if (!countdown_window) {
     return;
   }
-  if (!timer_is_elapsed(timer)) {
-    start_app_timer(MS_PER_SECOND, timer_handler, app_data);
+  struct Timer* timer = get_timer(countdown_window);
+  if (!timer) {
     return;
   }
-  struct Settings* settings = timer_group_get_settings(app_data_get_timer_group(app_data, s_timer_group_index));
-  timer_cancel_wakeup(timer);
-  vibrate_timer_handler(app_data);
-  if (settings_get_progress_style(settings) == PROGRESS_STYLE_AUTO) {
-    cancel_app_timers();
-    struct Timer* previous_timer = timer;
-    if (!update_current_timer(app_data)) {
-      update_timer_countdown_text_layer(timer);
-      update_timer_length_text_layer(timer);
-      return;
-    }
-    timer_reset(previous_timer);
-    timer = app_data_get_timer(app_data, s_timer_group_index, s_timer_index);
-    timer_reset(timer);
-    timer_start(timer);
-    timer_schedule_wakeup(timer);
-    start_app_timer(MS_PER_SECOND, timer_handler, app_data);
+  PROFILE_BEGIN(countdown_tick);
+  update_timer_countdown_text_layer(countdown_window, timer);
+  PROFILE_END(countdown_tick);
+  if (!timer_is_running(timer) || timer_is_elapsed(timer)) {
+    return;
   }
-  update_timer_countdown_text_layer(timer);
-  update_timer_length_text_layer(timer);
+  s_tick_handle = app_timer_register(MS_PER_SECOND, tick_handler, NULL);
 }
 
-static void vibrate_timer_handler(void* data)
+// Scheduler events
+static void scheduler_event_handler(const struct Scheduler_event_data* event_data, void* context)
 {
-  s_app_timer_vibrate_handle = NULL;
-  struct Timer* timer = app_data_get_timer(app_data_get(), s_timer_group_index, s_timer_index);
-  if (!(timer_is_running(timer) && timer_is_elapsed(timer))) {
-    return;
-  }
-  vibes_double_pulse();
-  s_app_timer_vibrate_handle = app_timer_register(NUDGE_INTERVAL_MS, vibrate_timer_handler, data);
-  struct Settings* settings = timer_group_get_settings(app_data_get_timer_group(app_data_get(), s_timer_group_index));
-  if (settings_get_progress_style(settings) != PROGRESS_STYLE_AUTO) {
-    timer_cancel_wakeup(timer);
-    wakeup_manager_schedule_nudge(app_data_get_wakeup_manager(app_data_get()), timer);
+  for (int i = 0; i < list_size(s_countdown_windows); ++i) {
+    struct Countdown_window* countdown_window = list_get(s_countdown_windows, i);
+    if (countdown_window->shown) {
+      handle_scheduler_event(countdown_window, event_data);
+    }
   }
 }
 
-static bool update_current_timer(struct App_data* app_data)
+static void handle_scheduler_event(struct Countdown_window* countdown_window,
+  const struct Scheduler_event_data* event_data)
 {
-  struct Timer_group* timer_group = app_data_get_timer_group(app_data, s_timer_group_index);
-  if (timer_group_size(timer_group) <= 0) {
-    return false;
-  }
-  struct Settings* settings = timer_group_get_settings(timer_group);
-  enum Progress_style progress_style = settings_get_progress_style(settings);
-  if (progress_style != PROGRESS_STYLE_AUTO && progress_style != PROGRESS_STYLE_WAIT_FOR_USER) {
-    // Can't progress; repeat the same timer and don't automatically start
-    return false;
+  struct Timer* timer = get_timer(countdown_window);
+  if (!timer) {
+    return;
   }
-  enum Repeat_style repeat_style = settings_get_repeat_style(settings);
-  switch (repeat_style) {
-    case REPEAT_STYLE_NONE:
-      if (s_timer_index >= (timer_group_size(timer_group) - 1)) {
-        return false;
+  switch (event_data->event) {
+    case SCHEDULER_EVENT_ELAPSED: // intentional fall through
+    case SCHEDULER_EVENT_NUDGE:
+      if (event_data->timer_id == countdown_window->timer_id) {
+        update_timer_countdown_text_layer(countdown_window, timer);
       }
-      ++s_timer_index;
-      return true;
-    case REPEAT_STYLE_SINGLE:
-      return true;
-    case REPEAT_STYLE_GROUP:
-      if (s_timer_index >= (timer_group_size(timer_group) - 1)) {
-        s_timer_index = 0;
-        return true;
+      return;
+    case SCHEDULER_EVENT_PROGRESS:
+      if (event_data->previous_timer_id != countdown_window->timer_id) {
+        return;
+      }
+      // Follow the group to its next timer
+      countdown_window->timer_id = event_data->timer_id;
+      timer = get_timer(countdown_window);
+      update_timer_countdown_text_layer(countdown_window, timer);
+      update_timer_length_text_layer(countdown_window, timer);
+      if (countdown_window == get_top()) {
+        start_tick(MS_PER_SECOND);
       }
-      ++s_timer_index;
-      return true;
-    case REPEAT_STYLE_INVALID: // intentional fall through
+      return;
+    case SCHEDULER_EVENT_INVALID: // intentional fall through
     default:
-      APP_LOG(APP_LOG_LEVEL_ERROR, "Invalid repeat style: %d", repeat_style);
-      return false;
+      APP_LOG(APP_LOG_LEVEL_ERROR, "Invalid scheduler event: %d", event_data->event);
+      return;
   }
-  return false;
 }
 
-static void update_timer_countdown_text_layer(struct Timer* timer)
+static void update_timer_countdown_text_layer(struct Countdown_window* countdown_window, struct Timer* timer)
 {
   timer_update(timer);
-  get_timer_text(s_timer_countdown_text_buffer, sizeof(s_timer_countdown_text_buffer),
+  get_timer_text(countdown_window->countdown_text_buffer, sizeof(countdown_window->countdown_text_buffer),
     timer_get_field_remaining(timer, TIMER_FIELD_HOURS),
     timer_get_field_remaining(timer, TIMER_FIELD_MINUTES),
     timer_get_field_remaining(timer, TIMER_FIELD_SECONDS));
-  text_layer_set_text(s_timer_countdown_text_layer, s_timer_countdown_text_buffer);
-  layer_mark_dirty(text_layer_get_layer(s_timer_countdown_text_layer));
+  countdown_layer_set_text(countdown_window->countdown_layer, countdown_window->countdown_text_buffer);
+  int length_seconds = timer_get_length_seconds(timer);
+  progress_layer_set_progress(countdown_window->progress_layer,
+    length_seconds - timer_get_remaining_seconds(timer), length_seconds);
 }
 
-static void update_timer_length_text_layer(struct Timer* timer)
+static void update_timer_length_text_layer(struct Countdown_window* countdown_window, struct Timer* timer)
 {
-  get_timer_text(s_timer_length_text_buffer, sizeof(s_timer_length_text_buffer),
+  get_timer_text(countdown_window->length_text_buffer, sizeof(countdown_window->length_text_buffer),
     timer_get_field(timer, TIMER_FIELD_HOURS),
     timer_get_field(timer, TIMER_FIELD_MINUTES),
     timer_get_field(timer, TIMER_FIELD_SECONDS));
-  text_layer_set_text(s_timer_length_text_layer, s_timer_length_text_buffer);
-  layer_mark_dirty(text_layer_get_layer(s_timer_length_text_layer));
+  text_layer_set_text(countdown_window->length_text_layer, countdown_window->length_text_buffer);
+  energy_count(ENERGY_COUNTER_REDRAW);
+  layer_mark_dirty(text_layer_get_layer(countdown_window->length_text_layer));
 }
@@ -1,7 +1,11 @@
 #ifndef TIMER_COUNTDOWN_WINDOW_H
 #define TIMER_COUNTDOWN_WINDOW_H
 
+// Push a countdown window for the timer. Each group has at most one countdown
+// window on the stack; if the group already has one it's brought to the front.
 void timer_countdown_window_push(int timer_group_index, int timer_index);
+// Push the window for the timer that is running in the given timer's group, or
+// for the given timer if none is running
 void timer_countdown_window_push_id(int timer_id);
 
 #endif /*TIMER_COUNTDOWN_WINDOW_H*/
@@ -6,15 +6,16 @@
 #include "Timer_group.h"
 #include "assert.h"
 #include "draw_utility.h"
-#include "Wakeup_manager.h"
-#include "wakeup_util.h"
+#include "Scheduler.h"
+#include "Time_format.h"
+#include "window_cache.h"
 
 #include <pebble.h>
 
 #define CLICK_REPEAT_INTERVAL_MS 100
 
 static Window* s_timer_edit_window;
-static TextLayer* s_timer_text_layer;
+static struct Countdown_layer* s_timer_layer;
 static int s_edit_timer_field_num;
 static int s_timer_group_index;
 static int s_timer_index;
@@ -39,36 +40,53 @@ static void update_timer_text_layer(const struct Timer* timer);
 
 // Helpers
 static enum Timer_field get_timer_field(int timer_edit_index);
+static void create_layers(Window* window);
+// Destroy the window and its layers
+static void destroy_window(Window* window);
 
 void timer_edit_window_push(int timer_group_index, int timer_index)
 {
-  s_timer_edit_window = window_create();
+  if (!s_timer_edit_window) {
+    s_timer_edit_window = window_create();
 
-  assert(s_timer_edit_window);
+    assert(s_timer_edit_window);
 
-  s_timer_group_index = timer_group_index;
-  s_timer_index = timer_index;
-
-  window_set_user_data(s_timer_edit_window, app_data_get());
+    window_set_user_data(s_timer_edit_window, app_data_get());
 
-  window_set_window_handlers(s_timer_edit_window, (WindowHandlers) {
-    .load = window_load_handler,
+    window_set_window_handlers(s_timer_edit_window, (WindowHandlers) {
+      .load = window_load_handler,
       .appear = window_appear_handler,
-    .unload = window_unload_handler
-  });
+      .unload = window_unload_handler
+    });
+  }
+  window_cache_take(s_timer_edit_window);
+
+  s_timer_group_index = timer_group_index;
+  s_timer_index = timer_index;
 
   window_stack_push(s_timer_edit_window, false);
 }
 
 static void window_load_handler(Window* window)
 {
-  Layer* window_layer = window_get_root_layer(window);
   window_set_click_config_provider(window, click_config_provider);
 
   // Setup other static variables
   s_edit_timer_field_num = 0;
   s_timer_text_buffer[0] = '\0';
 
+  if (!s_timer_layer) {
+    create_layers(window);
+  }
+  // Set the timer text
+  struct Timer* timer = app_data_get_timer(app_data_get(), s_timer_group_index, s_timer_index);
+  update_timer_text_layer(timer);
+}
+
+static void create_layers(Window* window)
+{
+  Layer* window_layer = window_get_root_layer(window);
+
   // Status bar layer
   s_status_bar_layer = status_bar_create();
   layer_add_child(window_layer, status_bar_layer_get_layer(s_status_bar_layer));
@@ -79,24 +97,17 @@ static void window_load_handler(Window* window)
   GRect timer_bounds = window_bounds;
   timer_bounds.size.h = TIMER_TEXT_HEIGHT;
   grect_align(&timer_bounds, &window_bounds, GAlignLeft, false);
-  s_timer_text_layer = text_layer_create(timer_bounds);
-  if (!s_timer_text_layer) {
-    APP_LOG(APP_LOG_LEVEL_ERROR, "Null menu layer");
+  s_timer_layer = countdown_layer_create(timer_bounds, fonts_get_system_font(FONT_KEY_LECO_32_BOLD_NUMBERS));
+  if (!s_timer_layer) {
+    APP_LOG(APP_LOG_LEVEL_ERROR, "Null timer layer");
     return;
   }
-  text_layer_set_text_color(s_timer_text_layer, GColorBlack);
-  text_layer_set_background_color(s_timer_text_layer, GColorWhite);
-  text_layer_set_text_alignment(s_timer_text_layer, GTextAlignmentCenter);
-  text_layer_set_font(s_timer_text_layer, fonts_get_system_font(FONT_KEY_LECO_32_BOLD_NUMBERS));
-  layer_add_child(window_layer, text_layer_get_layer(s_timer_text_layer));
-  // Set the timer text
-  struct Timer* timer = app_data_get_timer(app_data_get(), s_timer_group_index, s_timer_index);
-  update_timer_text_layer(timer);
+  layer_add_child(window_layer, countdown_layer_get_layer(s_timer_layer));
 }
 
 static void window_appear_handler(Window* window)
 {
-  timer_cancel_wakeup(app_data_get_timer(app_data_get(), s_timer_group_index, s_timer_index));
+  scheduler_timer_remove(app_data_get_timer(app_data_get(), s_timer_group_index, s_timer_index));
 }
 
 static void window_unload_handler(Window* window)
@@ -107,13 +118,21 @@ static void window_unload_handler(Window* window)
     timer_group_remove_timer(app_data_get_timer_group(app_data, s_timer_group_index), s_timer_index);
     timer_destroy(timer);
     timer = NULL;
+  } else {
+    // Pick the deadline back up if the timer was edited while running
+    scheduler_timer_add(timer);
   }
 
+  window_cache_release(s_timer_edit_window, destroy_window);
+}
+
+static void destroy_window(Window* window)
+{
   status_bar_layer_destroy(s_status_bar_layer);
   s_status_bar_layer = NULL;
 
-  text_layer_destroy(s_timer_text_layer);
-  s_timer_text_layer = NULL;
+  countdown_layer_destroy(s_timer_layer);
+  s_timer_layer = NULL;
 
   window_destroy(s_timer_edit_window);
   s_timer_edit_window = NULL;
@@ -160,12 +179,11 @@ static void click_handler_back(ClickRecognizerRef recognizer, void* context)
 
 static void update_timer_text_layer(const struct Timer* timer)
 {
-  snprintf(s_timer_text_buffer, sizeof(s_timer_text_buffer), "%.2d:%.2d:%.2d",
+  time_format_fixed(s_timer_text_buffer, sizeof(s_timer_text_buffer),
           timer_get_field(timer, TIMER_FIELD_HOURS),
           timer_get_field(timer, TIMER_FIELD_MINUTES),
           timer_get_field(timer, TIMER_FIELD_SECONDS));
-  text_layer_set_text(s_timer_text_layer, s_timer_text_buffer);
-  layer_mark_dirty(text_layer_get_layer(s_timer_text_layer));
+  countdown_layer_set_text(s_timer_layer, s_timer_text_buffer);
 }
 
 static enum Timer_field get_timer_field(int timer_edit_index)
@@ -10,16 +10,49 @@
 #include "Timer_group.h"
 #include "assert.h"
 #include "settings_window.h"
+#include "Model_events.h"
+#include "window_cache.h"
+#include "profile.h"
+#include "energy.h"
 
 #include <pebble.h>
 
 #define MENU_NUM_SECTIONS 2
-#define SETTINGS_NUM_ROWS 3
+
+// Rows of the settings section
+enum Settings_row {
+  SETTINGS_ROW_NEW_TIMER,
+  SETTINGS_ROW_SETTINGS,
+  SETTINGS_ROW_DELETE_GROUP,
+  SETTINGS_NUM_ROWS
+};
+
+static const char* const s_settings_row_texts[SETTINGS_NUM_ROWS] = {
+  [SETTINGS_ROW_NEW_TIMER] = "New Timer",
+  [SETTINGS_ROW_SETTINGS] = "Settings",
+  [SETTINGS_ROW_DELETE_GROUP] = "Delete Group"
+};
+
+// How much of the menu is out of date
+enum View_change {
+  VIEW_CHANGE_NONE,
+  VIEW_CHANGE_TEXT, // Timer rows show different text
+  VIEW_CHANGE_ROWS  // Timers were added or removed
+};
+
+// What the menu shows, so its callbacks don't go through the app data
+struct View_model {
+  enum View_change pending; // Not applied yet because the window is hidden
+  struct Timer_group* timer_group;
+  int num_timers;
+};
 
 static Window* s_timer_group_window;
 static MenuLayer* s_menu_layer;
 static int s_timer_group_index;
 static StatusBarLayer* s_status_bar_layer;
+static struct View_model s_view_model;
+static int s_model_events_handle;
 
 // WindowHandlers
 static void window_load_handler(Window* window);
@@ -37,26 +70,61 @@ static void menu_select_long_click_callback(MenuLayer* menu_layer, MenuIndex* ce
 
 // Helpers
 static void menu_cell_draw_timer_row(GContext* ctx, const Layer* cell_layer, uint16_t row_index, void* data);
+static void model_event_handler(const struct Model_event_data* event_data, void* context);
+// Record the change and apply it now if the window is showing
+static void view_changed(enum View_change view_change);
+static void apply_view_change();
+static void create_layers(Window* window);
+// Destroy the window and its layers
+static void destroy_window(Window* window);
 
 void timer_group_window_push(int timer_group)
 {
-  s_timer_group_window = window_create();
+  if (!s_timer_group_window) {
+    s_timer_group_window = window_create();
 
-  assert(s_timer_group_window);
+    assert(s_timer_group_window);
 
-  s_timer_group_index = timer_group;
+    window_set_window_handlers(s_timer_group_window, (WindowHandlers) {
+      .load = window_load_handler,
+      .appear = window_appear_handler,
+      .unload = window_unload_handler
+    });
+  }
+  window_cache_take(s_timer_group_window);
 
-  window_set_window_handlers(s_timer_group_window, (WindowHandlers) {
-    .load = window_load_handler,
-    .appear = window_appear_handler,
-    .unload = window_unload_handler
-  });
+  s_timer_group_index = timer_group;
 
   window_stack_push(s_timer_group_window, false);
 }
 
 // WindowHandlers
 static void window_load_handler(Window* window)
+{
+  PROFILE_BEGIN(timer_group_window_load);
+  bool cached = s_menu_layer != NULL;
+  if (!cached) {
+    create_layers(window);
+  }
+  menu_layer_set_click_config_onto_window(s_menu_layer, window);
+
+  s_view_model = (struct View_model) {
+    .pending = VIEW_CHANGE_NONE,
+    .timer_group = app_data_get_timer_group(app_data_get(), s_timer_group_index),
+  };
+  assert(s_view_model.timer_group);
+  s_view_model.num_timers = timer_group_size(s_view_model.timer_group);
+  s_model_events_handle = model_events_subscribe(model_event_handler, NULL);
+
+  if (cached) {
+    // Show the new group from the top
+    menu_layer_reload_data(s_menu_layer);
+    menu_layer_set_selected_index(s_menu_layer, (MenuIndex) {0, 0}, MenuRowAlignTop, false);
+  }
+  PROFILE_END(timer_group_window_load);
+}
+
+static void create_layers(Window* window)
 {
   Layer* window_layer = window_get_root_layer(window);
 
@@ -81,17 +149,24 @@ static void window_load_handler(Window* window)
     .select_long_click = menu_select_long_click_callback
   });
 
-  menu_layer_set_click_config_onto_window(s_menu_layer, window);
-
   layer_add_child(window_layer, menu_layer_get_layer(s_menu_layer));
 }
 
 static void window_appear_handler(Window* window)
 {
-  menu_layer_reload_data(s_menu_layer);
+  apply_view_change();
 }
 
 static void window_unload_handler(Window* window)
+{
+  model_events_unsubscribe(s_model_events_handle);
+  s_model_events_handle = INVALID_INDEX;
+  s_view_model.timer_group = NULL;
+
+  window_cache_release(s_timer_group_window, destroy_window);
+}
+
+static void destroy_window(Window* window)
 {
   menu_layer_destroy(s_menu_layer);
   s_menu_layer = NULL;
@@ -113,7 +188,7 @@ static uint16_t menu_get_num_rows_callback(MenuLayer* menu_layer, uint16_t secti
   switch (section_index) {
     case 0:
       // Timers
-      return timer_group_size(app_data_get_timer_group(app_data_get(), s_timer_group_index));
+      return s_view_model.num_timers;
     case 1:
       // Settings
       return SETTINGS_NUM_ROWS;
@@ -131,50 +206,81 @@ static int16_t menu_get_header_height_callback(MenuLayer* menu_layer, uint16_t s
 
 static void menu_draw_row_callback(GContext* ctx, const Layer* cell_layer, MenuIndex* cell_index, void* data)
 {
+  PROFILE_BEGIN(timer_group_draw_row);
+  energy_count(ENERGY_COUNTER_REDRAW);
   switch (cell_index->section) {
     case 0:
       menu_cell_draw_timer_row(ctx, cell_layer, cell_index->row, data);
-      return;
+      break;
     case 1:
-      if (cell_index->row == 0) {
-        // New timer
-        menu_cell_basic_draw(ctx, cell_layer, "New Timer", NULL, NULL);
-        return;
-      }
-      if (cell_index->row == 1) {
-        // Settings
-        menu_cell_basic_draw(ctx, cell_layer, "Settings", NULL, NULL);
-        return;
-      }
-      if (cell_index->row == 2) {
-        // Settings
-        menu_cell_basic_draw(ctx, cell_layer, "Delete Group", NULL, NULL);
-        return;
-      }
-      return;
+      assert(in_range(cell_index->row, 0, SETTINGS_NUM_ROWS));
+      menu_cell_basic_draw(ctx, cell_layer, s_settings_row_texts[cell_index->row], NULL, NULL);
+      break;
     default:
       APP_LOG(APP_LOG_LEVEL_ERROR, "Invalid section index: %d", cell_index->section);
-      return;
+      break;
   }
+  PROFILE_END(timer_group_draw_row);
 }
 
 static void menu_cell_draw_timer_row(GContext* ctx, const Layer* cell_layer, uint16_t row_index, void* data)
 {
   assert(ctx);
   assert(cell_layer);
-  assert(data);
+  assert(s_view_model.timer_group);
 
-  struct Timer_group* timer_group = app_data_get_timer_group(app_data_get(), s_timer_group_index);
-  assert(timer_group);
-  struct Timer* timer = timer_group_get_timer(timer_group, row_index);
-  assert(timer);
+  menu_cell_basic_draw(ctx, cell_layer, timer_group_get_timer_text(s_view_model.timer_group, row_index), NULL, NULL);
+}
 
-  char menu_text[MENU_TEXT_LENGTH];
-  get_timer_text(menu_text, sizeof(menu_text),
-        timer_get_field(timer, TIMER_FIELD_HOURS),
-        timer_get_field(timer, TIMER_FIELD_MINUTES),
-        timer_get_field(timer, TIMER_FIELD_SECONDS));
-  menu_cell_basic_draw(ctx, cell_layer, menu_text, NULL, NULL);
+static void model_event_handler(const struct Model_event_data* event_data, void* context)
+{
+  struct Timer_group* timer_group = s_view_model.timer_group;
+  if (!timer_group) {
+    return;
+  }
+  switch (event_data->event) {
+    case MODEL_EVENT_TIMER_ADDED: // intentional fall through
+    case MODEL_EVENT_TIMER_REMOVED:
+      if (event_data->subject == timer_group) {
+        view_changed(VIEW_CHANGE_ROWS);
+      }
+      return;
+    case MODEL_EVENT_TIMER_EDITED:
+      if (timer_group_get_timer_by_id(timer_group, timer_get_id(event_data->subject))) {
+        view_changed(VIEW_CHANGE_TEXT);
+      }
+      return;
+    default:
+      // Nothing else is shown
+      return;
+  }
+}
+
+static void view_changed(enum View_change view_change)
+{
+  if (view_change > s_view_model.pending) {
+    s_view_model.pending = view_change;
+  }
+  if (window_stack_get_top_window() == s_timer_group_window) {
+    apply_view_change();
+  }
+}
+
+static void apply_view_change()
+{
+  switch (s_view_model.pending) {
+    case VIEW_CHANGE_ROWS:
+      s_view_model.num_timers = timer_group_size(s_view_model.timer_group);
+      menu_layer_reload_data(s_menu_layer);
+      break;
+    case VIEW_CHANGE_TEXT:
+      layer_mark_dirty(menu_layer_get_layer(s_menu_layer));
+      break;
+    case VIEW_CHANGE_NONE: // intentional fall through
+    default:
+      break;
+  }
+  s_view_model.pending = VIEW_CHANGE_NONE;
 }
 
 static void menu_draw_header_callback(GContext* ctx, const Layer* cell_layer, uint16_t section_index, void* data)
@@ -203,32 +309,34 @@ static void menu_select_click_callback(MenuLayer* menu_layer, MenuIndex* cell_in
       timer_countdown_window_push(s_timer_group_index, cell_index->row);
       break;
     case 1:
-      if (cell_index->row == 0) {
-        // Edit/create timer
-        timer_group_add_timer(app_data_get_timer_group(app_data, s_timer_group_index), timer_create(app_data_get_next_timer_id(app_data)));
-        timer_edit_window_push(s_timer_group_index, timer_group_size(app_data_get_timer_group(app_data, s_timer_group_index)) - 1);
-      } else if (cell_index->row == 1) {
-        // Settings
-        settings_window_push(s_timer_group_index);
-      } else if (cell_index->row == 2) {
-        // Delete group
-        struct Timer_group* timer_group = app_data_get_timer_group(app_data, s_timer_group_index);
-        timer_group_cancel_wakeups(timer_group);
-        list_remove(app_data_get_timer_groups(app_data), s_timer_group_index);
-        timer_group_destroy(timer_group);
-        timer_group = NULL;
-        window_stack_pop(false);
-        return;
+      switch ((enum Settings_row) cell_index->row) {
+        case SETTINGS_ROW_NEW_TIMER:
+          timer_group_add_timer(s_view_model.timer_group, timer_create(app_data_get_next_timer_id(app_data)));
+          timer_edit_window_push(s_timer_group_index, timer_group_size(s_view_model.timer_group) - 1);
+          break;
+        case SETTINGS_ROW_SETTINGS:
+          settings_window_push(s_timer_group_index);
+          break;
+        case SETTINGS_ROW_DELETE_GROUP:
+        {
+          struct Timer_group* timer_group = s_view_model.timer_group;
+          timer_group_cancel_wakeups(timer_group);
+          app_data_remove_timer_group(app_data, s_timer_group_index);
+          timer_group_destroy(timer_group);
+          s_view_model.timer_group = NULL;
+          window_stack_pop(false);
+          return;
+        }
+        case SETTINGS_NUM_ROWS: // intentional fall through
+        default:
+          APP_LOG(APP_LOG_LEVEL_ERROR, "Invalid row index: %d", cell_index->row);
+          return;
       }
       break;
     default:
       APP_LOG(APP_LOG_LEVEL_ERROR, "Invalid section index: %d", cell_index->section);
       return;
   }
-  // Refresh window
-  // Todo: determine if these lines are necessary
-  layer_mark_dirty(menu_layer_get_layer(s_menu_layer));
-  menu_layer_reload_data(s_menu_layer);
 }
 
 static void menu_select_long_click_callback(MenuLayer* menu_layer, MenuIndex* cell_index, void* data)
@@ -242,8 +350,4 @@ static void menu_select_long_click_callback(MenuLayer* menu_layer, MenuIndex* ce
       APP_LOG(APP_LOG_LEVEL_DEBUG, "Only support long click on timers");
       return;
   }
-  // Refresh window
-  // Todo: determine if these lines are necessary
-  layer_mark_dirty(menu_layer_get_layer(s_menu_layer));
-  menu_layer_reload_data(s_menu_layer);
 }
@@ -0,0 +1,95 @@
+#include "trace.h"
+#include "Utility.h"
+#include "assert.h"
+
+#include <pebble.h>
+
+// Ring of records; s_first is the oldest
+static struct Trace_record s_records[TRACE_CAPACITY];
+static int s_first = 0;
+static int s_count = 0;
+
+// Helpers
+static const struct Trace_record* get_record(int index);
+static void append_record(const struct Trace_record* record);
+
+void trace_init()
+{
+  s_first = 0;
+  s_count = 0;
+  int count = persist_exists(TRACE_PERSIST_COUNT_KEY) ? persist_read_int(TRACE_PERSIST_COUNT_KEY) : 0;
+  count = min(max(count, 0), TRACE_CAPACITY);
+  for (int key = 0; key * TRACE_RECORDS_PER_KEY < count; ++key) {
+    struct Trace_record chunk[TRACE_RECORDS_PER_KEY];
+    int num_records = min(count - key * TRACE_RECORDS_PER_KEY, TRACE_RECORDS_PER_KEY);
+    int size = num_records * sizeof(struct Trace_record);
+    if (persist_read_data(TRACE_PERSIST_CHUNK_KEY(key), chunk, size) != size) {
+      APP_LOG(APP_LOG_LEVEL_WARNING, "Trace chunk %d missing, dropping the rest", key);
+      break;
+    }
+    for (int i = 0; i < num_records; ++i) {
+      append_record(&chunk[i]);
+    }
+  }
+  trace_event(TRACE_EVENT_LAUNCH, launch_reason(), 0);
+}
+
+void trace_deinit()
+{
+  trace_event(TRACE_EVENT_EXIT, 0, 0);
+  for (int key = 0; key * TRACE_RECORDS_PER_KEY < s_count; ++key) {
+    struct Trace_record chunk[TRACE_RECORDS_PER_KEY];
+    int num_records = min(s_count - key * TRACE_RECORDS_PER_KEY, TRACE_RECORDS_PER_KEY);
+    for (int i = 0; i < num_records; ++i) {
+      chunk[i] = *get_record(key * TRACE_RECORDS_PER_KEY + i);
+    }
+    persist_write_data(TRACE_PERSIST_CHUNK_KEY(key), chunk, num_records * sizeof(struct Trace_record));
+  }
+  persist_write_int(TRACE_PERSIST_COUNT_KEY, s_count);
+}
+
+void trace_event(enum Trace_event event, int arg0, int arg1)
+{
+  assert(in_range(event, 0, TRACE_NUM_EVENTS));
+  time_t seconds;
+  uint16_t ms;
+  time_ms(&seconds, &ms);
+  struct Trace_record record = {
+    .seconds = seconds,
+    .ms = ms,
+    .event = event,
+    .reserved = 0,
+    .arg0 = arg0,
+    .arg1 = arg1
+  };
+  append_record(&record);
+}
+
+void trace_log()
+{
+  for (int i = 0; i < s_count; ++i) {
+    const struct Trace_record* record = get_record(i);
+    APP_LOG(APP_LOG_LEVEL_INFO, "TRACE %d %lu %u %u %ld %ld", i, (unsigned long) record->seconds,
+      (unsigned) record->ms, (unsigned) record->event, (long) record->arg0, (long) record->arg1);
+  }
+}
+
+// Helpers
+// Record index counts from the oldest
+static const struct Trace_record* get_record(int index)
+{
+  assert(in_range(index, 0, s_count));
+  return &s_records[(s_first + index) % TRACE_CAPACITY];
+}
+
+// Overwrites the oldest record when full
+static void append_record(const struct Trace_record* record)
+{
+  if (s_count < TRACE_CAPACITY) {
+    s_records[(s_first + s_count) % TRACE_CAPACITY] = *record;
+    ++s_count;
+    return;
+  }
+  s_records[s_first] = *record;
+  s_first = (s_first + 1) % TRACE_CAPACITY;
+}
@@ -0,0 +1,57 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <pebble.h>
+
+/*
+Keeps the last TRACE_CAPACITY timing events in RAM, so a late or missing
+alert can be followed afterwards. The buffer is saved to its own persist keys
+when the app exits and reloaded when it starts, so it spans several launches.
+trace_log writes it to the app log, and tools/trace_decode.py turns that into
+a timeline.
+*/
+
+// Persist keys of the trace, far above the app data keys
+#define TRACE_PERSIST_KEY_BASE 200000
+#define TRACE_PERSIST_COUNT_KEY TRACE_PERSIST_KEY_BASE
+#define TRACE_PERSIST_CHUNK_KEY(index) (TRACE_PERSIST_KEY_BASE + 1 + (index))
+
+// Records per persist key; 16 records fill PERSIST_DATA_MAX_LENGTH
+#define TRACE_RECORDS_PER_KEY 16
+#define TRACE_NUM_KEYS 3
+#define TRACE_CAPACITY (TRACE_RECORDS_PER_KEY * TRACE_NUM_KEYS)
+
+// Saved as numbers, and tools/trace_decode.py has its own copy, so only append
+enum Trace_event {
+  TRACE_EVENT_LAUNCH,           // arg0: launch reason
+  TRACE_EVENT_EXIT,
+  TRACE_EVENT_TIMER_START,      // arg0: timer id, arg1: end time
+  TRACE_EVENT_TIMER_PAUSE,      // arg0: timer id, arg1: remaining seconds
+  TRACE_EVENT_TIMER_ELAPSED,    // arg0: timer id, arg1: end time
+  TRACE_EVENT_VIBRATION,        // arg0: timer id, arg1: time the alert was due
+  TRACE_EVENT_WAKEUP_SCHEDULED, // arg0: timer id, arg1: wakeup time
+  TRACE_EVENT_WAKEUP_FIRED,     // arg0: cookie, arg1: time the wakeup was armed for, 0 if unknown
+  TRACE_EVENT_WAKEUP_CANCELLED, // arg0: wakeup id, -1 for all, arg1: time it was armed for
+  TRACE_EVENT_APP_TIMER_FIRED,  // arg1: time the app timer was armed for
+  TRACE_NUM_EVENTS
+};
+
+// Layout of a saved record, little endian
+struct Trace_record {
+  uint32_t seconds; // Since the epoch
+  uint16_t ms;
+  uint8_t event;    // enum Trace_event
+  uint8_t reserved;
+  int32_t arg0;
+  int32_t arg1;
+};
+
+// Load the trace saved by the previous launch. Should be called first thing.
+void trace_init();
+// Save the trace. Should be called last thing before exiting.
+void trace_deinit();
+void trace_event(enum Trace_event event, int arg0, int arg1);
+// Write every record, oldest first, as "TRACE <seq> <seconds> <ms> <event> <arg0> <arg1>"
+void trace_log();
+
+#endif /*TRACE_H*/
@@ -0,0 +1,92 @@
+#include "window_cache.h"
+#include "assert.h"
+
+#include <pebble.h>
+
+// Most windows kept at a time
+#define WINDOW_CACHE_SIZE 4
+
+struct Cache_entry {
+  Window* window;
+  Window_cache_destroy_fp_t destroy_fp;
+};
+
+// Oldest first
+static struct Cache_entry s_entries[WINDOW_CACHE_SIZE];
+static int s_num_entries = 0;
+static bool s_flushed = false;
+
+// Helpers
+static int find_entry(const Window* window);
+static void remove_entry(int index);
+// Destroy the oldest windows until there is enough free heap
+static void trim();
+
+void window_cache_release(Window* window, Window_cache_destroy_fp_t destroy_fp)
+{
+  assert(window);
+  assert(destroy_fp);
+  if (s_flushed) {
+    destroy_fp(window);
+    return;
+  }
+  int index = find_entry(window);
+  if (index >= 0) {
+    remove_entry(index);
+  }
+  if (s_num_entries >= WINDOW_CACHE_SIZE) {
+    s_entries[0].destroy_fp(s_entries[0].window);
+    remove_entry(0);
+  }
+  s_entries[s_num_entries++] = (struct Cache_entry) {
+    .window = window,
+    .destroy_fp = destroy_fp
+  };
+  trim();
+}
+
+void window_cache_take(Window* window)
+{
+  int index = find_entry(window);
+  if (index >= 0) {
+    remove_entry(index);
+  }
+  // Make room for the window being pushed
+  trim();
+}
+
+void window_cache_flush()
+{
+  while (s_num_entries > 0) {
+    s_entries[0].destroy_fp(s_entries[0].window);
+    remove_entry(0);
+  }
+  s_flushed = true;
+}
+
+static int find_entry(const Window* window)
+{
+  for (int i = 0; i < s_num_entries; ++i) {
+    if (s_entries[i].window == window) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void remove_entry(int index)
+{
+  for (int i = index; i < s_num_entries - 1; ++i) {
+    s_entries[i] = s_entries[i + 1];
+  }
+  --s_num_entries;
+}
+
+static void trim()
+{
+  while (s_num_entries > 0 && heap_bytes_free() < WINDOW_CACHE_MIN_FREE_HEAP) {
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "Low on heap, destroying a cached window");
+    s_entries[0].destroy_fp(s_entries[0].window);
+    remove_entry(0);
+  }
+}
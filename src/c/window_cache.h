@@ -0,0 +1,29 @@
+#ifndef WINDOW_CACHE_H
+#define WINDOW_CACHE_H
+
+#include <pebble.h>
+
+/*
+Keeps popped windows and their layers alive so pushing them again only rebinds
+them to new data. Windows are released to the cache from their unload handler
+and taken back out when they're pushed. The least recently used windows are
+destroyed whenever free heap drops below WINDOW_CACHE_MIN_FREE_HEAP.
+*/
+
+// Free heap to leave for everything else, in bytes
+#define WINDOW_CACHE_MIN_FREE_HEAP 6144
+
+// Destroys a window and its layers
+typedef void (*Window_cache_destroy_fp_t)(Window* window);
+
+// Keep the unloaded window for reuse, or destroy it with destroy_fp if there
+// isn't enough free heap
+void window_cache_release(Window* window, Window_cache_destroy_fp_t destroy_fp);
+// Stop tracking the window, which is about to be pushed, and make room for it.
+// Should be called before every push, cached or not.
+void window_cache_take(Window* window);
+// Destroy all cached windows. Windows released afterwards are destroyed right
+// away. Should be called when the app is exiting.
+void window_cache_flush();
+
+#endif /*WINDOW_CACHE_H*/
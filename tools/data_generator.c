@@ -0,0 +1,197 @@
+/*
+Host side of the app's test data generator (src/c/Data_generator.c). Builds
+the same groups the watch builds from a seed, prints them if asked, and times
+the pure model code the scheduler runs over every group: filling the prefix
+sums, planning the wakeups, locating a group after a long absence and running
+the state machine to its first deadline. Run it with growing sizes to see how
+the model scales before trying the same sizes on the watch.
+
+Build and run from the repository root:
+  cc -O2 -Isrc/c tools/data_generator.c src/c/Data_generator.c src/c/Schedule_planner.c \
+    src/c/Run_state.c src/c/Nudge_policy.c -o data_generator
+  ./data_generator [-p] [groups] [timers] [seed]
+
+The defaults match the "Generate data" row of the debug menu, which logs the
+seed it used.
+*/
+
+#include "Data_generator.h"
+#include "Schedule_planner.h"
+#include "Run_state.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Same as src/c/test_data.h
+#define TEST_DATA_NUM_GROUPS 8
+#define TEST_DATA_NUM_TIMERS 4
+#define TEST_DATA_MIN_LENGTH 5
+#define TEST_DATA_MAX_LENGTH (2 * 60 * 60)
+#define TEST_DATA_RUNNING_PERCENT 25
+
+// Virtual time the groups start at, in seconds since the epoch
+#define START_TIME 1000000000
+// How long the app is away before locate catches a group up
+#define ABSENCE (7 * 24 * 60 * 60)
+#define ITERATIONS 100
+
+static const char* const s_repeat_texts[] = {"none", "single", "group"};
+static const char* const s_progress_texts[] = {"none", "auto", "wait"};
+static const char* const s_vibrate_texts[] = {"none", "nudge", "continuous", "backoff", "limited"};
+
+struct Group {
+  struct Generated_group generated;
+  int* lengths;
+  int* prefix_sums;
+};
+
+static double now_seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int clock_start_time(void* context)
+{
+  return START_TIME;
+}
+
+static void count_event(const struct Run_event_data* event_data, void* context)
+{
+  ++*(long*) context;
+}
+
+static void get_run_config(const struct Group* group, int num_timers, struct Run_config* config)
+{
+  *config = (struct Run_config) {
+    .prefix_sums = group->prefix_sums,
+    .num_timers = num_timers,
+    .repeat_style = group->generated.repeat_style,
+    .progress_style = group->generated.progress_style,
+    .vibrate_style = group->generated.vibrate_style
+  };
+}
+
+static void print_groups(const struct Group* groups, const struct Data_generator_params* params)
+{
+  for (int i = 0; i < params->num_groups; ++i) {
+    const struct Group* group = &groups[i];
+    printf("group %s %s %s", s_repeat_texts[group->generated.repeat_style],
+      s_progress_texts[group->generated.progress_style], s_vibrate_texts[group->generated.vibrate_style]);
+    for (int j = 0; j < params->num_timers; ++j) {
+      printf(" %d", group->lengths[j]);
+    }
+    if (group->generated.running_timer_index >= 0) {
+      printf("  # timer %d running", group->generated.running_timer_index);
+    }
+    printf("\n");
+  }
+}
+
+// Run each step over every group ITERATIONS times and print the nanoseconds per group
+static void bench(struct Group* groups, const struct Data_generator_params* params)
+{
+  int num_groups = params->num_groups;
+  int num_timers = params->num_timers;
+  long checksum = 0;
+  struct Planned_transition transitions[SCHEDULE_PLAN_LENGTH];
+  struct Run_env env = {clock_start_time, NULL, count_event, &checksum};
+
+  double start = now_seconds();
+  for (int k = 0; k < ITERATIONS; ++k) {
+    for (int i = 0; i < num_groups; ++i) {
+      schedule_planner_fill_prefix_sums(groups[i].lengths, num_timers, groups[i].prefix_sums);
+    }
+  }
+  double prefix_sums_ns = (now_seconds() - start) * 1e9 / ((double) ITERATIONS * num_groups);
+
+  start = now_seconds();
+  for (int k = 0; k < ITERATIONS; ++k) {
+    for (int i = 0; i < num_groups; ++i) {
+      struct Generated_group* generated = &groups[i].generated;
+      checksum += schedule_planner_plan(groups[i].prefix_sums, num_timers, generated->repeat_style,
+        generated->progress_style, 0, START_TIME, transitions, SCHEDULE_PLAN_LENGTH);
+    }
+  }
+  double plan_ns = (now_seconds() - start) * 1e9 / ((double) ITERATIONS * num_groups);
+
+  start = now_seconds();
+  for (int k = 0; k < ITERATIONS; ++k) {
+    for (int i = 0; i < num_groups; ++i) {
+      struct Generated_group* generated = &groups[i].generated;
+      struct Schedule_position position;
+      schedule_planner_locate(groups[i].prefix_sums, num_timers, generated->repeat_style,
+        generated->progress_style, 0, ABSENCE, &position);
+      checksum += position.timer_index;
+    }
+  }
+  double locate_ns = (now_seconds() - start) * 1e9 / ((double) ITERATIONS * num_groups);
+
+  start = now_seconds();
+  for (int k = 0; k < ITERATIONS; ++k) {
+    for (int i = 0; i < num_groups; ++i) {
+      struct Run_config config;
+      get_run_config(&groups[i], num_timers, &config);
+      struct Run_state state = run_state_running(0, START_TIME - ABSENCE);
+      run_state_handle_deadline(&state, &config, &env);
+      checksum += run_state_get_deadline(&state, &config);
+    }
+  }
+  double run_state_ns = (now_seconds() - start) * 1e9 / ((double) ITERATIONS * num_groups);
+
+  printf("%d groups of %d timers, ns per group:\n", num_groups, num_timers);
+  printf("  prefix sums  %10.1f\n", prefix_sums_ns);
+  printf("  plan         %10.1f\n", plan_ns);
+  printf("  locate       %10.1f\n", locate_ns);
+  printf("  run state    %10.1f\n", run_state_ns);
+  printf("checksum %ld\n", checksum);
+}
+
+int main(int argc, char** argv)
+{
+  int print = argc > 1 && !strcmp(argv[1], "-p");
+  if (print) {
+    --argc;
+    ++argv;
+  }
+  struct Data_generator_params params = {
+    .num_groups = argc > 1 ? atoi(argv[1]) : TEST_DATA_NUM_GROUPS,
+    .num_timers = argc > 2 ? atoi(argv[2]) : TEST_DATA_NUM_TIMERS,
+    .min_length = TEST_DATA_MIN_LENGTH,
+    .max_length = TEST_DATA_MAX_LENGTH,
+    .running_percent = TEST_DATA_RUNNING_PERCENT,
+    .seed = argc > 3 ? strtoul(argv[3], NULL, 10) : 1
+  };
+  if (params.num_groups <= 0 || params.num_timers <= 0) {
+    fprintf(stderr, "usage: %s [-p] [groups] [timers] [seed]\n", argv[0]);
+    return 1;
+  }
+
+  struct Data_generator generator;
+  data_generator_init(&generator, &params);
+  struct Group* groups = calloc(params.num_groups, sizeof(struct Group));
+  for (int i = 0; i < params.num_groups; ++i) {
+    // Same order of draws as test_data_generate
+    data_generator_next_group(&generator, &groups[i].generated);
+    groups[i].lengths = malloc(params.num_timers * sizeof(int));
+    groups[i].prefix_sums = malloc((params.num_timers + 1) * sizeof(int));
+    for (int j = 0; j < params.num_timers; ++j) {
+      groups[i].lengths[j] = data_generator_next_length(&generator);
+    }
+  }
+
+  if (print) {
+    print_groups(groups, &params);
+  }
+  bench(groups, &params);
+
+  for (int i = 0; i < params.num_groups; ++i) {
+    free(groups[i].lengths);
+    free(groups[i].prefix_sums);
+  }
+  free(groups);
+  return 0;
+}
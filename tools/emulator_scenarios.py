@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+"""
+Runs scripted scenarios of the app in the Pebble emulator of every platform
+and reports startup time, window load times and free heap per platform.
+
+Needs the pebble tool and a debug build (release builds don't log the
+profile):
+  pebble build
+  tools/emulator_scenarios.py [-p basalt] [-o report_dir] [tools/scenarios/navigation.scn ...]
+
+Without scenario arguments, every tools/scenarios/*.scn runs. Without -p,
+every platform in package.json's targetPlatforms runs. Each platform starts
+from a wiped emulator. The raw log of every scenario and a report per
+platform go to the report directory, and a summary of all platforms is
+printed at the end.
+
+The numbers come from the app's own log: main.c logs "Startup: N bytes free"
+once it's up and writes the profile (src/c/profile.h) when it exits, so each
+launch between those two lines is a session. A session that doesn't exit by
+the end of the scenario has no profile.
+
+Scenario lines:
+  install                  Install the build and launch it. Installing again
+                           relaunches the app and keeps its data.
+  click <button> [count]   Click back, up, select or down
+  long <button>            Long click
+  wait <seconds>           Let time pass. Wakeups the app registered launch it
+                           if it's closed, the same as on a watch.
+Anything after # is a comment.
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BUTTONS = ("back", "up", "select", "down")
+# Time between clicks, so the app handles each one before the next
+CLICK_INTERVAL = 0.5
+LONG_CLICK_MS = 1000
+# Time for the logs of an exiting app to arrive
+LOG_SETTLE = 3
+
+STARTUP_LINE = re.compile(r"Startup: (\d+) bytes free")
+PROFILE_LINE = re.compile(r"Profile: (\d+) scopes, (\d+) bytes free")
+SCOPE_LINE = re.compile(r"(\w+): count (\d+), total (\d+) ms, avg (\d+) ms, max (\d+) ms")
+
+# Scopes shown in the summary, as column titles
+SUMMARY_SCOPES = [
+    ("init", "startup"),
+    ("main_window_load", "main"),
+    ("timer_group_window_load", "group"),
+    ("countdown_window_load", "countdown"),
+]
+
+
+def pebble(platform, *args, **kwargs):
+    command = ["pebble"] + list(args) + ["--emulator", platform]
+    return subprocess.run(command, cwd=ROOT, check=True, **kwargs)
+
+
+def parse_scenario(path):
+    steps = []
+    with open(path) as scenario:
+        for number, line in enumerate(scenario, 1):
+            words = line.split("#", 1)[0].split()
+            if not words:
+                continue
+            command, args = words[0], words[1:]
+            valid = (
+                (command == "install" and not args)
+                or (command == "click" and 1 <= len(args) <= 2 and args[0] in BUTTONS
+                    and (len(args) == 1 or args[1].isdigit()))
+                or (command == "long" and len(args) == 1 and args[0] in BUTTONS)
+                or (command == "wait" and len(args) == 1 and re.fullmatch(r"\d+(\.\d+)?", args[0]))
+            )
+            if not valid:
+                sys.exit("%s:%d: bad line: %s" % (path, number, line.strip()))
+            steps.append((command, args))
+    return steps
+
+
+def run_step(platform, command, args):
+    if command == "install":
+        pebble(platform, "install")
+    elif command == "click":
+        for _ in range(int(args[1]) if len(args) > 1 else 1):
+            pebble(platform, "emu-button", "click", args[0])
+            time.sleep(CLICK_INTERVAL)
+    elif command == "long":
+        pebble(platform, "emu-button", "click", args[0], "--duration", str(LONG_CLICK_MS))
+        time.sleep(CLICK_INTERVAL)
+    elif command == "wait":
+        time.sleep(float(args[0]))
+
+
+def run_scenario(platform, path, log_path):
+    steps = parse_scenario(path)
+    with open(log_path, "w") as log:
+        logs = subprocess.Popen(["pebble", "logs", "--emulator", platform], cwd=ROOT,
+                                stdout=log, stderr=subprocess.STDOUT)
+        try:
+            for command, args in steps:
+                run_step(platform, command, args)
+            time.sleep(LOG_SETTLE)
+        finally:
+            logs.terminate()
+            logs.wait()
+    with open(log_path) as log:
+        return parse_sessions(log)
+
+
+def parse_sessions(lines):
+    """Split a log into sessions of {"startup_heap", "exit_heap", "scopes"}."""
+    sessions = []
+    session = None
+    for line in lines:
+        match = STARTUP_LINE.search(line)
+        if match:
+            session = {"startup_heap": int(match.group(1)), "exit_heap": None, "scopes": {}}
+            sessions.append(session)
+            continue
+        # Profiles before the first startup belong to a launch from before the scenario
+        if session is None:
+            continue
+        match = PROFILE_LINE.search(line)
+        if match:
+            session["exit_heap"] = int(match.group(2))
+            continue
+        match = SCOPE_LINE.search(line)
+        if match and session["exit_heap"] is not None:
+            name, count, total, avg, max_ms = match.groups()
+            session["scopes"][name] = {"count": int(count), "total": int(total), "max": int(max_ms)}
+    return sessions
+
+
+def merge_scopes(sessions):
+    scopes = {}
+    for session in sessions:
+        for name, scope in session["scopes"].items():
+            merged = scopes.setdefault(name, {"count": 0, "total": 0, "max": 0})
+            merged["count"] += scope["count"]
+            merged["total"] += scope["total"]
+            merged["max"] = max(merged["max"], scope["max"])
+    return scopes
+
+
+def write_report(path, platform, results):
+    with open(path, "w") as report:
+        report.write("Platform %s\n" % platform)
+        for scenario, sessions in results:
+            report.write("\n%s: %d sessions\n" % (scenario, len(sessions)))
+            for index, session in enumerate(sessions, 1):
+                exit_heap = session["exit_heap"]
+                report.write("  session %d: %d bytes free at startup, %s at exit\n" % (
+                    index, session["startup_heap"], "no profile" if exit_heap is None else "%d" % exit_heap))
+            scopes = merge_scopes(sessions)
+            for name in sorted(scopes):
+                scope = scopes[name]
+                report.write("  %-26s count %6d  avg %5d ms  max %5d ms\n" % (
+                    name, scope["count"], scope["total"] // max(scope["count"], 1), scope["max"]))
+
+
+def summary_row(platform, results):
+    sessions = [session for _, scenario_sessions in results for session in scenario_sessions]
+    scopes = merge_scopes(sessions)
+    row = [platform]
+    for name, _ in SUMMARY_SCOPES:
+        row.append("%d" % scopes[name]["max"] if name in scopes else "-")
+    heaps = [session["startup_heap"] for session in sessions]
+    heaps += [session["exit_heap"] for session in sessions if session["exit_heap"] is not None]
+    row.append("%d" % min(heaps) if heaps else "-")
+    return row
+
+
+def target_platforms():
+    with open(os.path.join(ROOT, "package.json")) as package:
+        return json.load(package)["pebble"]["targetPlatforms"]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run app scenarios in the Pebble emulators.")
+    parser.add_argument("-p", "--platform", action="append", help="platform to run, repeatable")
+    parser.add_argument("-o", "--output", default=os.path.join(ROOT, "build", "scenarios"),
+                        help="directory of the logs and reports")
+    parser.add_argument("scenarios", nargs="*")
+    args = parser.parse_args()
+
+    platforms = args.platform or target_platforms()
+    scenarios = args.scenarios or sorted(glob.glob(os.path.join(ROOT, "tools", "scenarios", "*.scn")))
+    for scenario in scenarios:
+        parse_scenario(scenario)
+    os.makedirs(args.output, exist_ok=True)
+
+    rows = []
+    for platform in platforms:
+        print("%s: wiping the emulator" % platform, flush=True)
+        pebble(platform, "wipe", stdout=subprocess.DEVNULL)
+        # Boots the emulator, so the logs of the first scenario start with it
+        pebble(platform, "install", stdout=subprocess.DEVNULL)
+        results = []
+        for scenario in scenarios:
+            name = os.path.splitext(os.path.basename(scenario))[0]
+            print("%s: %s" % (platform, name), flush=True)
+            log_path = os.path.join(args.output, "%s-%s.log" % (platform, name))
+            results.append((name, run_scenario(platform, scenario, log_path)))
+        write_report(os.path.join(args.output, "%s.txt" % platform), platform, results)
+        rows.append(summary_row(platform, results))
+
+    titles = ["platform"] + [title + " ms" for _, title in SUMMARY_SCOPES] + ["min heap free"]
+    print()
+    print("  ".join("%-13s" % title for title in titles))
+    for row in rows:
+        print("  ".join("%-13s" % cell for cell in row))
+    print("\nReports in %s" % args.output)
+
+
+if __name__ == "__main__":
+    main()
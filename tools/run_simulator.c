@@ -0,0 +1,412 @@
+/*
+Host simulator of a timer group's run state machine (src/c/Run_state.c) over
+virtual time. Replays a script of button presses and app closes, lets wakeups
+launch the app while it's closed, and checks the alerts against expectations.
+The clock jumps from one deadline to the next, so a schedule of days runs in
+milliseconds.
+
+Build and run from the repository root:
+  cc -O2 -Isrc/c tools/run_simulator.c src/c/Run_state.c src/c/Schedule_planner.c \
+    src/c/Nudge_policy.c -o run_simulator
+  ./run_simulator [-q] tools/simulations/twelve_hour_repeat.sim ...
+
+Script lines, times in seconds from the start of the script:
+  group <repeat> <progress> <vibrate> <length>...
+      repeat: none, single, group; progress: none, auto, wait;
+      vibrate: none, nudge, continuous, backoff, limited
+  launch_delay <seconds>   Time from a wakeup to the app handling it
+  at <time> start <index>  Long select on the group in the main window
+  at <time> select         Select in the countdown window
+  at <time> reset          Up in the countdown window
+  at <time> close          Exit the app. Wakeups launch it again, and it
+  at <time> open           stays open until the next close.
+  run <time>               Simulate until then
+  expect <time> <index>    An alert for the timer at index happens at time
+  expect_count <count>     Alerts in the whole script
+Anything after # is a comment.
+
+While the app is closed, the wakeups it registered are what the app
+registers: the next SCHEDULE_PLAN_LENGTH transitions of a running group, or
+the next NUDGE_PLAN_LENGTH nudges of an elapsed timer that are at least
+NUDGE_MIN_WAKEUP_INTERVAL apart.
+*/
+
+#include "Run_state.h"
+#include "Schedule_planner.h"
+#include "Nudge_policy.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_TIMERS 64
+#define MAX_ALERTS 100000
+#define MAX_EXPECTS 256
+#define MAX_WAKEUPS (SCHEDULE_PLAN_LENGTH > NUDGE_PLAN_LENGTH ? SCHEDULE_PLAN_LENGTH : NUDGE_PLAN_LENGTH)
+#define LINE_LENGTH 512
+// Virtual time the script starts at, in seconds since the epoch
+#define START_TIME 1000000000
+
+struct Alert {
+  int time;
+  int timer_index;
+  int due_time;
+  enum Run_event event;
+};
+
+struct Expect {
+  int time;
+  int timer_index;
+  int line;
+};
+
+struct Simulation {
+  // Group
+  int lengths[MAX_TIMERS];
+  int prefix_sums[MAX_TIMERS + 1];
+  struct Run_config config;
+  struct Run_state state;
+  int launch_delay;
+  // App
+  int now;
+  int open;
+  int wakeups[MAX_WAKEUPS]; // Registered while closed, earliest first
+  int num_wakeups;
+  int num_launches;
+  // Results
+  struct Alert* alerts;
+  int num_alerts;
+  struct Expect expects[MAX_EXPECTS];
+  int num_expects;
+  int expected_count; // Negative if not checked
+  int verbose;
+};
+
+static int clock_handler(void* context)
+{
+  const struct Simulation* simulation = context;
+  return simulation->now;
+}
+
+static void event_handler(const struct Run_event_data* event_data, void* context)
+{
+  struct Simulation* simulation = context;
+  if (event_data->event == RUN_EVENT_PROGRESS) {
+    if (simulation->verbose) {
+      printf("%10d  progress %d -> %d\n", simulation->now - START_TIME, event_data->previous_timer_index,
+        event_data->timer_index);
+    }
+    return;
+  }
+  if (simulation->num_alerts >= MAX_ALERTS) {
+    fprintf(stderr, "Too many alerts\n");
+    exit(2);
+  }
+  struct Alert* alert = &simulation->alerts[simulation->num_alerts++];
+  alert->time = simulation->now;
+  alert->timer_index = event_data->timer_index;
+  alert->due_time = event_data->due_time;
+  alert->event = event_data->event;
+  if (simulation->verbose) {
+    printf("%10d  %-7s timer %d, due %d, late %d s%s\n", alert->time - START_TIME,
+      alert->event == RUN_EVENT_ELAPSED ? "elapsed" : "nudge", alert->timer_index, alert->due_time - START_TIME,
+      alert->time - alert->due_time, simulation->open ? "" : " (wakeup launch)");
+  }
+}
+
+static struct Run_env get_env(struct Simulation* simulation)
+{
+  return (struct Run_env) {
+    .clock = clock_handler,
+    .clock_context = simulation,
+    .sink = event_handler,
+    .sink_context = simulation
+  };
+}
+
+// What the app registers as wakeups when it exits
+static void plan_wakeups(struct Simulation* simulation)
+{
+  const struct Run_state* state = &simulation->state;
+  const struct Run_config* config = &simulation->config;
+  simulation->num_wakeups = 0;
+  if (state->phase == RUN_PHASE_RUNNING) {
+    struct Planned_transition transitions[SCHEDULE_PLAN_LENGTH];
+    int num_transitions = schedule_planner_plan(config->prefix_sums, config->num_timers, config->repeat_style,
+      config->progress_style, state->timer_index, state->end_time, transitions, SCHEDULE_PLAN_LENGTH);
+    for (int i = 0; i < num_transitions; ++i) {
+      simulation->wakeups[simulation->num_wakeups++] = transitions[i].time;
+    }
+  } else if (state->phase == RUN_PHASE_ELAPSED && state->nudge_index >= 0) {
+    int next_index;
+    simulation->num_wakeups = nudge_policy_plan(config->vibrate_style, state->end_time, state->nudge_index,
+      simulation->wakeups, NUDGE_PLAN_LENGTH, &next_index);
+  }
+}
+
+// What the app knows when it launches: a timer that waits for the user and ran
+// past its end looks the same whether it alerted already or not, so the app
+// rebuilds its state the way the scheduler does. fired_time is when the
+// launch wakeup was due, or RUN_NO_DEADLINE.
+static void relaunch(struct Simulation* simulation, int fired_time)
+{
+  struct Run_state* state = &simulation->state;
+  if ((state->phase == RUN_PHASE_RUNNING || state->phase == RUN_PHASE_ELAPSED) &&
+      state->end_time <= simulation->now && simulation->config.progress_style != PROGRESS_STYLE_AUTO) {
+    *state = run_state_relaunch(&simulation->config, state->timer_index, state->end_time, fired_time,
+      simulation->now);
+  }
+}
+
+static void handle_due(struct Simulation* simulation)
+{
+  struct Run_env env = get_env(simulation);
+  while (run_state_handle_deadline(&simulation->state, &simulation->config, &env)) {
+  }
+}
+
+// Simulate until the given time, then leave the clock there
+static void advance(struct Simulation* simulation, int until)
+{
+  for (;;) {
+    int next = RUN_NO_DEADLINE;
+    if (simulation->open) {
+      next = run_state_get_deadline(&simulation->state, &simulation->config);
+    } else if (simulation->num_wakeups > 0) {
+      next = simulation->wakeups[0];
+    }
+    if (next == RUN_NO_DEADLINE || next > until) {
+      break;
+    }
+    if (simulation->open) {
+      simulation->now = next;
+      handle_due(simulation);
+      continue;
+    }
+    // A wakeup launches the app, which catches up and registers wakeups again.
+    // Of the wakeups due by then, the latest one decides.
+    simulation->now = next + simulation->launch_delay;
+    ++simulation->num_launches;
+    int fired_time = next;
+    for (int i = 0; i < simulation->num_wakeups && simulation->wakeups[i] <= simulation->now; ++i) {
+      fired_time = simulation->wakeups[i];
+    }
+    relaunch(simulation, fired_time);
+    handle_due(simulation);
+    plan_wakeups(simulation);
+    if (simulation->num_wakeups > 0 && simulation->wakeups[0] <= next) {
+      fprintf(stderr, "Wakeup at %d didn't move the group on\n", next - START_TIME);
+      exit(2);
+    }
+  }
+  if (until > simulation->now) {
+    simulation->now = until;
+  }
+}
+
+static int parse_enum(const char* text, const char* const* names, int num_names)
+{
+  for (int i = 0; i < num_names; ++i) {
+    if (strcmp(text, names[i]) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void parse_group(struct Simulation* simulation, char* args, const char* path, int line)
+{
+  static const char* const repeat_names[] = { "none", "single", "group" };
+  static const char* const progress_names[] = { "none", "auto", "wait" };
+  static const char* const vibrate_names[] = { "none", "nudge", "continuous", "backoff", "limited" };
+  char* repeat = strtok(args, " \t");
+  char* progress = strtok(NULL, " \t");
+  char* vibrate = strtok(NULL, " \t");
+  int repeat_style = repeat ? parse_enum(repeat, repeat_names, 3) : -1;
+  int progress_style = progress ? parse_enum(progress, progress_names, 3) : -1;
+  int vibrate_style = vibrate ? parse_enum(vibrate, vibrate_names, 5) : -1;
+  if (repeat_style < 0 || progress_style < 0 || vibrate_style < 0) {
+    fprintf(stderr, "%s:%d: bad group settings\n", path, line);
+    exit(2);
+  }
+  int num_timers = 0;
+  char* length;
+  while ((length = strtok(NULL, " \t")) && num_timers < MAX_TIMERS) {
+    simulation->lengths[num_timers++] = atoi(length);
+  }
+  if (num_timers == 0) {
+    fprintf(stderr, "%s:%d: group has no timers\n", path, line);
+    exit(2);
+  }
+  schedule_planner_fill_prefix_sums(simulation->lengths, num_timers, simulation->prefix_sums);
+  simulation->config = (struct Run_config) {
+    .prefix_sums = simulation->prefix_sums,
+    .num_timers = num_timers,
+    .repeat_style = repeat_style,
+    .progress_style = progress_style,
+    .vibrate_style = vibrate_style
+  };
+  simulation->state = (struct Run_state) { .phase = RUN_PHASE_STOPPED, .timer_index = 0, .nudge_index = -1 };
+}
+
+static void run_action(struct Simulation* simulation, const char* action, const char* arg, const char* path,
+  int line)
+{
+  if (strcmp(action, "close") == 0) {
+    simulation->open = 0;
+    plan_wakeups(simulation);
+    return;
+  }
+  // Any action opens the app, which catches up on anything that's due first
+  if (!simulation->open) {
+    simulation->open = 1;
+    simulation->num_wakeups = 0;
+    relaunch(simulation, RUN_NO_DEADLINE);
+    handle_due(simulation);
+  }
+  struct Run_env env = get_env(simulation);
+  if (strcmp(action, "start") == 0) {
+    int timer_index = arg ? atoi(arg) : 0;
+    if (timer_index < 0 || timer_index >= simulation->config.num_timers) {
+      fprintf(stderr, "%s:%d: no timer %d\n", path, line, timer_index);
+      exit(2);
+    }
+    run_state_start_timer(&simulation->state, &simulation->config, timer_index, &env);
+  } else if (strcmp(action, "select") == 0) {
+    run_state_select(&simulation->state, &simulation->config, &env);
+  } else if (strcmp(action, "reset") == 0) {
+    run_state_reset(&simulation->state);
+  } else if (strcmp(action, "open") != 0) {
+    fprintf(stderr, "%s:%d: unknown action %s\n", path, line, action);
+    exit(2);
+  }
+  handle_due(simulation);
+}
+
+static void run_script(struct Simulation* simulation, const char* path)
+{
+  FILE* file = fopen(path, "r");
+  if (!file) {
+    perror(path);
+    exit(2);
+  }
+  char text[LINE_LENGTH];
+  int line = 0;
+  while (fgets(text, sizeof(text), file)) {
+    ++line;
+    char* comment = strchr(text, '#');
+    if (comment) {
+      *comment = '\0';
+    }
+    char* command = strtok(text, " \t\r\n");
+    if (!command) {
+      continue;
+    }
+    char* rest = strtok(NULL, "\r\n");
+    if (strcmp(command, "group") == 0) {
+      parse_group(simulation, rest ? rest : "", path, line);
+    } else if (strcmp(command, "launch_delay") == 0) {
+      simulation->launch_delay = rest ? atoi(rest) : 0;
+    } else if (strcmp(command, "run") == 0) {
+      advance(simulation, START_TIME + (rest ? atoi(rest) : 0));
+    } else if (strcmp(command, "at") == 0) {
+      char* time_text = rest ? strtok(rest, " \t") : NULL;
+      char* action = strtok(NULL, " \t");
+      char* arg = strtok(NULL, " \t");
+      if (!time_text || !action) {
+        fprintf(stderr, "%s:%d: expected at <time> <action>\n", path, line);
+        exit(2);
+      }
+      if (simulation->config.num_timers == 0) {
+        fprintf(stderr, "%s:%d: no group yet\n", path, line);
+        exit(2);
+      }
+      advance(simulation, START_TIME + atoi(time_text));
+      run_action(simulation, action, arg, path, line);
+    } else if (strcmp(command, "expect") == 0) {
+      struct Expect* expect = &simulation->expects[simulation->num_expects];
+      if (simulation->num_expects >= MAX_EXPECTS || !rest ||
+          sscanf(rest, "%d %d", &expect->time, &expect->timer_index) != 2) {
+        fprintf(stderr, "%s:%d: expected expect <time> <index>\n", path, line);
+        exit(2);
+      }
+      expect->time += START_TIME;
+      expect->line = line;
+      ++simulation->num_expects;
+    } else if (strcmp(command, "expect_count") == 0) {
+      simulation->expected_count = rest ? atoi(rest) : 0;
+    } else {
+      fprintf(stderr, "%s:%d: unknown command %s\n", path, line, command);
+      exit(2);
+    }
+  }
+  fclose(file);
+}
+
+// Return the number of failed expectations
+static int check(const struct Simulation* simulation, const char* path)
+{
+  int num_failed = 0;
+  for (int i = 0; i < simulation->num_expects; ++i) {
+    const struct Expect* expect = &simulation->expects[i];
+    int found = 0;
+    for (int j = 0; j < simulation->num_alerts && !found; ++j) {
+      found = simulation->alerts[j].time == expect->time && simulation->alerts[j].timer_index == expect->timer_index;
+    }
+    if (!found) {
+      printf("%s:%d: no alert for timer %d at %d\n", path, expect->line, expect->timer_index,
+        expect->time - START_TIME);
+      ++num_failed;
+    }
+  }
+  if (simulation->expected_count >= 0 && simulation->num_alerts != simulation->expected_count) {
+    printf("%s: %d alerts, expected %d\n", path, simulation->num_alerts, simulation->expected_count);
+    ++num_failed;
+  }
+  return num_failed;
+}
+
+int main(int argc, char** argv)
+{
+  int verbose = 1;
+  int first_path = 1;
+  if (argc > 1 && strcmp(argv[1], "-q") == 0) {
+    verbose = 0;
+    first_path = 2;
+  }
+  if (first_path >= argc) {
+    fprintf(stderr, "usage: %s [-q] script...\n", argv[0]);
+    return 2;
+  }
+  struct Alert* alerts = malloc(MAX_ALERTS * sizeof(struct Alert));
+  if (!alerts) {
+    return 2;
+  }
+  int num_failed_scripts = 0;
+  for (int i = first_path; i < argc; ++i) {
+    struct Simulation simulation;
+    memset(&simulation, 0, sizeof(simulation));
+    simulation.now = START_TIME;
+    simulation.open = 1;
+    simulation.alerts = alerts;
+    simulation.expected_count = -1;
+    simulation.verbose = verbose;
+    if (verbose) {
+      printf("%s\n", argv[i]);
+    }
+    clock_t begin = clock();
+    run_script(&simulation, argv[i]);
+    double seconds = (double) (clock() - begin) / CLOCKS_PER_SEC;
+    int num_failed = check(&simulation, argv[i]);
+    int simulated = simulation.now - START_TIME;
+    printf("%s: %s, %d alerts, %d wakeup launches, %d s simulated in %.3f ms (%.0f s/s)\n", argv[i],
+      num_failed ? "FAILED" : "ok", simulation.num_alerts, simulation.num_launches, simulated, seconds * 1000,
+      seconds > 0 ? simulated / seconds : 0.0);
+    if (num_failed) {
+      ++num_failed_scripts;
+    }
+  }
+  free(alerts);
+  return num_failed_scripts ? 1 : 0;
+}
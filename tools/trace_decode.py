@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""
+Turns the app's trace (src/c/trace.h) into a timeline.
+
+Select "Log trace" in the app's debug menu with `pebble logs` running, then
+feed the log to this script:
+  pebble logs > app.log
+  tools/trace_decode.py app.log
+
+Each line shows the time of the event, the time since the previous one and,
+for events that were due at a known time, how late they happened.
+"""
+
+import re
+import sys
+from datetime import datetime, timezone
+
+# Same order as enum Trace_event
+EVENT_NAMES = [
+    "launch",
+    "exit",
+    "timer start",
+    "timer pause",
+    "timer elapsed",
+    "vibration",
+    "wakeup scheduled",
+    "wakeup fired",
+    "wakeup cancelled",
+    "app timer fired",
+]
+
+# AppLaunchReason
+LAUNCH_REASONS = [
+    "system",
+    "user",
+    "phone",
+    "wakeup",
+    "worker",
+    "quick launch",
+    "timeline action",
+    "smartstrap",
+]
+
+# Events whose arg1 is the time they were due
+DUE_EVENTS = {"timer elapsed", "vibration", "wakeup fired", "app timer fired"}
+
+TRACE_LINE = re.compile(r"TRACE (\d+) (\d+) (\d+) (\d+) (-?\d+) (-?\d+)")
+
+
+def parse(lines):
+    records = {}
+    for line in lines:
+        match = TRACE_LINE.search(line)
+        if not match:
+            continue
+        seq, seconds, ms, event, arg0, arg1 = (int(field) for field in match.groups())
+        # The latest dump wins if the log holds several
+        records[seq] = (seconds * 1000 + ms, event, arg0, arg1)
+    return [records[seq] for seq in sorted(records)]
+
+
+def describe(name, arg0, arg1):
+    if name == "launch":
+        return "reason " + (LAUNCH_REASONS[arg0] if 0 <= arg0 < len(LAUNCH_REASONS) else str(arg0))
+    if name == "exit":
+        return ""
+    if name == "timer start":
+        return "timer %d, ends %s" % (arg0, format_time(arg1 * 1000))
+    if name == "timer pause":
+        return "timer %d, %d s left" % (arg0, arg1)
+    if name in ("timer elapsed", "vibration", "wakeup scheduled"):
+        return "timer %d, due %s" % (arg0, format_time(arg1 * 1000))
+    if name == "wakeup fired":
+        return "cookie %d, armed for %s" % (arg0, format_time(arg1 * 1000) if arg1 else "unknown")
+    if name == "wakeup cancelled":
+        return ("all" if arg0 < 0 else "wakeup %d" % arg0) + (", armed for " + format_time(arg1 * 1000) if arg1 else "")
+    if name == "app timer fired":
+        return "armed for " + (format_time(arg1 * 1000) if arg1 >= 0 else "nothing")
+    return "%d %d" % (arg0, arg1)
+
+
+def format_time(time_ms):
+    time = datetime.fromtimestamp(time_ms / 1000, tz=timezone.utc)
+    return time.strftime("%Y-%m-%d %H:%M:%S.") + "%03d" % (time_ms % 1000)
+
+
+def main():
+    if len(sys.argv) > 2:
+        sys.exit("usage: %s [log file]" % sys.argv[0])
+    with (open(sys.argv[1]) if len(sys.argv) == 2 else sys.stdin) as log:
+        records = parse(log)
+    if not records:
+        sys.exit("no TRACE lines found")
+
+    previous_ms = None
+    for time_ms, event, arg0, arg1 in records:
+        name = EVENT_NAMES[event] if event < len(EVENT_NAMES) else "event %d" % event
+        delta = "" if previous_ms is None else "%+d ms" % (time_ms - previous_ms)
+        line = "%s %10s  %-17s %s" % (format_time(time_ms), delta, name, describe(name, arg0, arg1))
+        if name in DUE_EVENTS and arg1 > 0:
+            line += "  (late %d ms)" % (time_ms - arg1 * 1000)
+        print(line.rstrip())
+        previous_ms = time_ms
+
+
+if __name__ == "__main__":
+    main()